@@ -0,0 +1,80 @@
+#include "../include/arena.h"
+#include "../include/directed_weighted_graph.h"
+#include "../include/undirected_weighted_graph.h"
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+/*
+ * Benchmark of building and destroying the mutable graph classes,
+ * with the nodes allocated from the global heap and from an arena.
+ *
+ * Every configuration inserts the same random edges, either one
+ * `addEdge` at a time or in a single `addEdges` batch ("bulk"), and
+ * then destroys the graph. Build and teardown times are reported
+ * separately.
+ *
+ * usage: construction_bench [vertices] [edges]
+ */
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsedMs(bench_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+template <class Graph>
+static void run(const std::string &name, const std::vector<weighted_edge> &edges,
+                std::shared_ptr<arena> pool, bool bulk)
+{
+    auto begin = bench_clock::now();
+    Graph *g = pool ? new Graph(pool) : new Graph();
+    if (bulk)
+    {
+        g->addEdges(edges);
+    }
+    else
+    {
+        for (const auto &e : edges)
+        {
+            g->addEdge(e.source, e.dest, e.weight);
+        }
+    }
+    double build = elapsedMs(begin);
+    std::size_t count = g->countEdges();
+
+    begin = bench_clock::now();
+    delete g;
+    pool.reset();
+    double teardown = elapsedMs(begin);
+
+    std::cout << name << "\tbuild " << build << " ms\tteardown " << teardown
+              << " ms\t(" << count << " edges)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int vertices = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int edges = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    std::mt19937 rng(7);
+    std::vector<weighted_edge> list(edges);
+    for (auto &e : list)
+    {
+        e.source = rng() % vertices;
+        e.dest = rng() % vertices;
+        e.weight = 1 + rng() % 100;
+    }
+
+    std::cout << vertices << " vertices, " << edges << " edges" << std::endl;
+    run<directed_weighted_graph>("directed   heap       ", list, nullptr, false);
+    run<directed_weighted_graph>("directed   arena      ", list, std::make_shared<arena>(), false);
+    run<directed_weighted_graph>("directed   heap  bulk ", list, nullptr, true);
+    run<directed_weighted_graph>("directed   arena bulk ", list, std::make_shared<arena>(), true);
+    run<undirected_weighted_graph>("undirected heap       ", list, nullptr, false);
+    run<undirected_weighted_graph>("undirected arena      ", list, std::make_shared<arena>(), false);
+    run<undirected_weighted_graph>("undirected heap  bulk ", list, nullptr, true);
+    run<undirected_weighted_graph>("undirected arena bulk ", list, std::make_shared<arena>(), true);
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "../include/directed_weighted_graph.h"
+#include "../include/external_graph.h"
+#include "../include/shortestPath.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+/*
+ * Correctness check and benchmark of external_graph.
+ *
+ * Writes a random directed graph to an adjacency file, once from its
+ * CSR form and once from its compressed form, and runs the same
+ * single source queries on the file and in memory, with a cache
+ * holding the whole file and with room for a few blocks only. The
+ * last run splits the queries over several threads sharing one
+ * external_graph. Reports the query time and the I/O statistics of
+ * every run, and exits with 1 if any distance differs.
+ *
+ * usage: external_bench [vertices] [edges] [queries] [threads]
+ */
+
+struct run_result
+{
+    int wrong;
+    double seconds;
+};
+
+static run_result run(const shortestPath &solver, const std::vector<int> &sources,
+                      const std::vector<std::vector<int>> &expected, int threads)
+{
+    std::vector<int> wrong(threads, 0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            for (std::size_t i = t; i < sources.size(); i += threads)
+            {
+                wrong[t] += solver.compute(sources[i]) != expected[i];
+            }
+        });
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    run_result result{0, seconds};
+    for (int w : wrong)
+    {
+        result.wrong += w;
+    }
+    return result;
+}
+
+static bool check(const std::string &name, const std::string &filename, std::size_t cacheBytes,
+                  const std::vector<int> &sources, const std::vector<std::vector<int>> &expected,
+                  int threads)
+{
+    external_graph g(cacheBytes, 4096);
+    if (!g.open(filename))
+    {
+        std::cout << name << ": cannot open " << filename << std::endl;
+        return false;
+    }
+    shortestPath solver(g);
+    run_result r = run(solver, sources, expected, threads);
+
+    external_graph::io_stats s = g.stats();
+    std::cout << name << ": " << r.seconds * 1000 / sources.size() << " ms/query, " << r.wrong
+              << " wrong" << std::endl;
+    std::cout << "  hits " << s.hits << ", misses " << s.misses << ", evictions " << s.evictions
+              << ", prefetches " << s.prefetches << ", " << s.bytesRead / (1 << 20) << " MiB read"
+              << std::endl;
+    return r.wrong == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int vertices = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int edges = argc > 2 ? std::atoi(argv[2]) : 4 * vertices;
+    int queries = argc > 3 ? std::atoi(argv[3]) : 20;
+    int threads = std::max(1, argc > 4 ? std::atoi(argv[4]) : 4);
+
+    std::mt19937 rng(13);
+    std::vector<weighted_edge> list;
+    for (int i = 0; i < edges; ++i)
+    {
+        list.push_back(weighted_edge{static_cast<int>(rng() % vertices),
+                                     static_cast<int>(rng() % vertices),
+                                     1 + static_cast<int>(rng() % 1000)});
+    }
+    directed_weighted_graph g(vertices);
+    g.addEdges(list);
+    csr_graph csr(g);
+    compressed_graph compressed(csr);
+
+    // the expected answers, from the in-memory solver
+    shortestPath memory(g);
+    std::vector<int> sources(queries);
+    std::vector<std::vector<int>> expected(queries);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; ++i)
+    {
+        sources[i] = rng() % vertices;
+        expected[i] = memory.compute(sources[i]);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << vertices << " vertices, " << g.countEdges() << " edges, " << queries
+              << " queries" << std::endl;
+    std::cout << "in memory: " << seconds * 1000 / queries << " ms/query" << std::endl;
+
+    std::string pid = std::to_string(getpid());
+    std::string fromCsr = "external_bench.csr." + pid + ".bin";
+    std::string fromCompressed = "external_bench.zip." + pid + ".bin";
+    bool ok = external_graph::write(fromCsr, csr) && external_graph::write(fromCompressed, compressed);
+    if (!ok)
+    {
+        std::cout << "writing the adjacency files failed" << std::endl;
+    }
+    else
+    {
+        std::size_t whole = 64 << 20, tiny = 8 * 4096;
+        ok = check("external, whole file cached", fromCsr, whole, sources, expected, 1) && ok;
+        ok = check("external, 8 blocks cached", fromCsr, tiny, sources, expected, 1) && ok;
+        ok = check("external from compressed", fromCompressed, tiny, sources, expected, 1) && ok;
+        std::string parallel = "external, 8 blocks, " + std::to_string(threads) + " threads";
+        ok = check(parallel, fromCsr, tiny, sources, expected, threads) && ok;
+    }
+    std::remove(fromCsr.c_str());
+    std::remove(fromCompressed.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include "../include/hub_labels.h"
+#include "../include/shortestPath.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+/*
+ * Correctness check and benchmark of hub_labels.
+ *
+ * Builds the labels of a random directed and of a random undirected
+ * graph, then compares the distance of every pair of vertices with
+ * the one given by shortestPath::compute, once on the labels just
+ * built and once on labels written to a file and read back. Reports
+ * the construction time, the label sizes and the mean query time, and
+ * exits with 1 if any distance differs.
+ *
+ * usage: hub_labels_bench [vertices] [edges] [threads]
+ */
+
+static std::vector<weighted_edge> randomEdges(int vertices, int edges, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<weighted_edge> result;
+    for (int i = 0; i < edges; ++i)
+    {
+        result.push_back(weighted_edge{static_cast<int>(rng() % vertices),
+                                       static_cast<int>(rng() % vertices),
+                                       1 + static_cast<int>(rng() % 100)});
+    }
+    return result;
+}
+
+// number of pairs whose distance differs from the one of `expected`
+static long long mismatches(const hub_labels &labels, const std::vector<std::vector<int>> &expected)
+{
+    long long wrong = 0;
+    for (int s = 0; s < labels.countVertices(); ++s)
+    {
+        for (int t = 0; t < labels.countVertices(); ++t)
+        {
+            wrong += labels.distance(s, t) != expected[s][t];
+        }
+    }
+    return wrong;
+}
+
+template <class Graph>
+static bool check(const char *name, int vertices, int edges, int threads, unsigned seed)
+{
+    Graph g(vertices);
+    g.addEdges(randomEdges(vertices, edges, seed));
+
+    auto start = std::chrono::steady_clock::now();
+    hub_labels labels(g, threads);
+    double built = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    shortestPath solver(g);
+    std::vector<std::vector<int>> expected(vertices);
+    for (int s = 0; s < vertices; ++s)
+    {
+        expected[s] = solver.compute(s);
+    }
+
+    start = std::chrono::steady_clock::now();
+    long long wrong = mismatches(labels, expected);
+    double queried = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // the same check on a round trip through a file
+    std::string filename = "hub_labels_bench." + std::to_string(getpid()) + ".bin";
+    hub_labels loaded;
+    bool io = labels.write(filename) && loaded.read(filename);
+    std::remove(filename.c_str());
+    long long wrongLoaded = io ? mismatches(loaded, expected) : 0;
+
+    double pairs = double(vertices) * vertices;
+    std::cout << name << ": " << vertices << " vertices, " << g.countEdges() << " edges" << std::endl;
+    std::cout << "  built in " << built << " s, " << labels.countEntries() << " entries ("
+              << double(labels.countEntries()) / vertices << " per vertex)" << std::endl;
+    std::cout << "  " << pairs / queried << " queries/s, " << wrong << " wrong" << std::endl;
+    std::cout << "  file round trip " << (io ? "ok" : "failed") << ", " << wrongLoaded << " wrong"
+              << std::endl;
+    return wrong == 0 && io && wrongLoaded == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int vertices = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int edges = argc > 2 ? std::atoi(argv[2]) : 4 * vertices;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+
+    bool ok = check<directed_weighted_graph>("directed", vertices, edges, threads, 3);
+    ok = check<undirected_weighted_graph>("undirected", vertices, edges, threads, 7) && ok;
+    return ok ? 0 : 1;
+}
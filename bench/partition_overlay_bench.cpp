@@ -0,0 +1,159 @@
+#include "../include/directed_weighted_graph.h"
+#include "../include/partition_overlay.h"
+#include "../include/shortestPath.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+/*
+ * Correctness check and benchmark of partition_overlay.
+ *
+ * Builds a grid shaped directed graph, with different random weights
+ * in the two directions and a few random long edges, and an overlay
+ * of three levels of cells of at most 64, 512 and 4096 vertices.
+ * Compares the overlay distances of sampled <source, target> pairs
+ * with the ones of shortestPath::compute, then repeats the check
+ * after every round of random weight updates and customization.
+ * Reports the construction, customization and query times, and exits
+ * with 1 if any distance differs.
+ *
+ * usage: partition_overlay_bench [side] [sources] [targets] [updates]
+ *                                [rounds]
+ */
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsedMs(bench_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+static std::vector<weighted_edge> roadLike(int side, std::mt19937 &rng)
+{
+    std::vector<weighted_edge> edges;
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            int v = y * side + x;
+            if (x + 1 < side)
+            {
+                edges.push_back(weighted_edge{v, v + 1, 1 + static_cast<int>(rng() % 100)});
+                edges.push_back(weighted_edge{v + 1, v, 1 + static_cast<int>(rng() % 100)});
+            }
+            if (y + 1 < side)
+            {
+                edges.push_back(weighted_edge{v, v + side, 1 + static_cast<int>(rng() % 100)});
+                edges.push_back(weighted_edge{v + side, v, 1 + static_cast<int>(rng() % 100)});
+            }
+        }
+    }
+    // a few long, one way edges crossing many cells
+    int vertices = side * side;
+    for (int i = 0; i < side / 10; ++i)
+    {
+        int source = rng() % vertices, dest = rng() % vertices;
+        int dx = source % side - dest % side, dy = source / side - dest / side;
+        if (std::abs(dx) + std::abs(dy) > 1)
+        {
+            edges.push_back(weighted_edge{source, dest, 20 * (std::abs(dx) + std::abs(dy))});
+        }
+    }
+    return edges;
+}
+
+// number of sampled pairs whose overlay distance is wrong
+static long long mismatches(const partition_overlay &overlay, const std::vector<weighted_edge> &edges,
+                            const std::vector<int> &sources, const std::vector<int> &targets,
+                            double &queryMs)
+{
+    directed_weighted_graph g(overlay.countVertices());
+    g.addEdges(edges);
+    shortestPath solver(g);
+
+    search_workspace workspace;
+    long long wrong = 0;
+    queryMs = 0;
+    for (int s : sources)
+    {
+        std::vector<int> expected = solver.compute(s);
+        auto begin = bench_clock::now();
+        for (int t : targets)
+        {
+            wrong += overlay.distance(s, t, workspace) != expected[t];
+        }
+        queryMs += elapsedMs(begin);
+    }
+    return wrong;
+}
+
+int main(int argc, char *argv[])
+{
+    int side = argc > 1 ? std::atoi(argv[1]) : 120;
+    int sourceCount = argc > 2 ? std::atoi(argv[2]) : 10;
+    int targetCount = argc > 3 ? std::atoi(argv[3]) : 300;
+    int updates = argc > 4 ? std::atoi(argv[4]) : 1000;
+    int rounds = argc > 5 ? std::atoi(argv[5]) : 3;
+
+    std::mt19937 rng(17);
+    std::vector<weighted_edge> edges = roadLike(side, rng);
+    int vertices = side * side;
+    directed_weighted_graph g(vertices);
+    g.addEdges(edges);
+
+    auto begin = bench_clock::now();
+    partition_overlay overlay(csr_graph(g), std::vector<int>{64, 512, 4096});
+    double build = elapsedMs(begin);
+
+    std::cout << side << "x" << side << " grid, " << g.countEdges() << " edges, "
+              << overlay.countLevels() << " levels" << std::endl;
+    for (int l = 0; l < overlay.countLevels(); ++l)
+    {
+        std::cout << "  level " << l << ": " << overlay.countCells(l) << " cells, "
+                  << overlay.countBoundaryVertices(l) << " boundary vertices" << std::endl;
+    }
+    std::cout << "built in " << build << " ms" << std::endl;
+
+    std::vector<int> sources(sourceCount), targets(targetCount);
+    for (int &s : sources)
+    {
+        s = rng() % vertices;
+    }
+    for (int &t : targets)
+    {
+        t = rng() % vertices;
+    }
+    double pairs = double(sourceCount) * targetCount;
+    // the grid edges come first in the list
+    std::size_t gridEdges = 4 * side * (side - 1);
+
+    double queryMs;
+    long long wrong = mismatches(overlay, edges, sources, targets, queryMs);
+    std::cout << "initial metric: " << pairs << " pairs, " << wrong << " wrong, "
+              << queryMs * 1000 / pairs << " us/query" << std::endl;
+    bool ok = wrong == 0;
+
+    for (int r = 1; r <= rounds; ++r)
+    {
+        // the grid edges have no parallel edges, so updating one of
+        // them in the overlay and in the edge list gives the same graph
+        for (int i = 0; i < updates; ++i)
+        {
+            weighted_edge &e = edges[rng() % gridEdges];
+            e.weight = 1 + rng() % 100;
+            overlay.updateWeight(e.source, e.dest, e.weight);
+        }
+
+        begin = bench_clock::now();
+        int cells = overlay.customize();
+        double customize = elapsedMs(begin);
+
+        wrong = mismatches(overlay, edges, sources, targets, queryMs);
+        std::cout << "round " << r << ": " << updates << " updates, customize " << customize
+                  << " ms (" << cells << " cells), " << wrong << " wrong, "
+                  << queryMs * 1000 / pairs << " us/query" << std::endl;
+        ok = ok && wrong == 0;
+    }
+    return ok ? 0 : 1;
+}
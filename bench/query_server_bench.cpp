@@ -0,0 +1,168 @@
+#include "../include/query_server.h"
+#include "../include/undirected_weighted_graph.h"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+
+/*
+ * Load test of query_server, without any external service.
+ *
+ * Builds a grid shaped graph and serves it over a pair of pipes from
+ * the same process: one thread writes the request lines, with their
+ * sources drawn from a small set of hot sources, while the main
+ * thread reads and checks the answers as they stream back. Reports
+ * the throughput, the average batch size, the maximum queue depth and
+ * the latency histogram.
+ *
+ * The same graph can also be served to other processes, on stdin and
+ * stdout or on a Unix domain socket (until the process is killed),
+ * e.g. `echo "1 0 42" | query_server_bench serve`.
+ *
+ * usage: query_server_bench [side] [requests] [sources] [threads]
+ *        query_server_bench serve [side]
+ *        query_server_bench socket <path> [side]
+ */
+
+static undirected_weighted_graph grid(int side)
+{
+    std::mt19937 rng(11);
+    std::vector<weighted_edge> edges;
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            int v = y * side + x;
+            if (x + 1 < side)
+            {
+                edges.push_back(weighted_edge{v, v + 1, 1 + static_cast<int>(rng() % 9)});
+            }
+            if (y + 1 < side)
+            {
+                edges.push_back(weighted_edge{v, v + side, 1 + static_cast<int>(rng() % 9)});
+            }
+        }
+    }
+    undirected_weighted_graph g(side * side);
+    g.addEdges(edges);
+    return g;
+}
+
+int main(int argc, char *argv[])
+{
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (argc > 1 && std::strcmp(argv[1], "serve") == 0)
+    {
+        query_server server(grid(argc > 2 ? std::atoi(argv[2]) : 300));
+        return server.serve(STDIN_FILENO, STDOUT_FILENO) ? 0 : 1;
+    }
+    if (argc > 2 && std::strcmp(argv[1], "socket") == 0)
+    {
+        query_server server(grid(argc > 3 ? std::atoi(argv[3]) : 300));
+        return server.serveUnix(argv[2]) ? 0 : 1;
+    }
+
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int sources = argc > 3 ? std::atoi(argv[3]) : 16;
+    int threads = argc > 4 ? std::atoi(argv[4]) : 0;
+
+    undirected_weighted_graph g = grid(side);
+    int vertices = side * side;
+    auto solver = std::make_shared<const shortestPath>(g);
+
+    // the expected answers, one search per hot source
+    std::mt19937 rng(5);
+    std::vector<int> hot(sources);
+    std::vector<std::vector<int>> expected(sources);
+    for (int i = 0; i < sources; ++i)
+    {
+        hot[i] = rng() % vertices;
+        expected[i] = solver->compute(hot[i]);
+    }
+    std::vector<std::pair<int, int>> sent(requests);
+    for (auto &r : sent)
+    {
+        r = std::make_pair(static_cast<int>(rng() % sources), static_cast<int>(rng() % vertices));
+    }
+
+    int toServer[2], fromServer[2];
+    if (pipe(toServer) < 0 || pipe(fromServer) < 0)
+    {
+        std::cerr << "pipe: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    query_server server(solver, threads);
+    auto start = std::chrono::steady_clock::now();
+    std::thread serving([&]() {
+        server.serve(toServer[0], fromServer[1]);
+        close(fromServer[1]);
+    });
+    std::thread client([&]() {
+        std::string lines;
+        for (int i = 0; i < requests; ++i)
+        {
+            lines += std::to_string(i) + " " + std::to_string(hot[sent[i].first]) + " " +
+                     std::to_string(sent[i].second) + "\n";
+        }
+        std::size_t written = 0;
+        while (written < lines.size())
+        {
+            ssize_t n = write(toServer[1], lines.data() + written, lines.size() - written);
+            if (n <= 0)
+            {
+                break;
+            }
+            written += n;
+        }
+        close(toServer[1]);
+    });
+
+    // read the answers as they come, in completion order
+    int answers = 0, wrong = 0;
+    std::string pending;
+    char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = read(fromServer[0], buffer, sizeof(buffer))) > 0)
+    {
+        pending.append(buffer, n);
+        std::size_t begin = 0, end;
+        while ((end = pending.find('\n', begin)) != std::string::npos)
+        {
+            std::istringstream line(pending.substr(begin, end - begin));
+            int id, distance;
+            std::string status;
+            line >> id >> status >> distance;
+            const auto &r = sent[id];
+            wrong += status != "ok" || distance != expected[r.first][r.second];
+            ++answers;
+            begin = end + 1;
+        }
+        pending.erase(0, begin);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    client.join();
+    serving.join();
+
+    query_server::metrics m = server.stats();
+    std::cout << side << "x" << side << " grid, " << requests << " requests over " << sources
+              << " sources" << std::endl;
+    std::cout << "answers " << answers << " (" << wrong << " wrong), " << requests / elapsed
+              << " requests/s" << std::endl;
+    std::cout << "batches " << m.batches << " (" << double(m.requests) / m.batches
+              << " requests per search), max queue depth " << m.maxQueueDepth << std::endl;
+    std::cout << "latency (us)" << std::endl;
+    for (int i = 0; i < query_server::latencyBuckets; ++i)
+    {
+        if (m.latency[i] > 0)
+        {
+            std::cout << "  >= " << (i == 0 ? 0 : 1ull << i) << "\t" << m.latency[i] << std::endl;
+        }
+    }
+    return wrong == 0 && answers == requests ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include "../include/graph_reorder.h"
+#include "../include/shortestPath.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Benchmark of the vertex orderings in graph_reorder.h.
+ *
+ * Builds a grid shaped (road like) graph whose vertex labels are
+ * randomly shuffled, then runs the same single source queries with
+ * the original labels and with every ordering, and reports the mean
+ * query time and the hardware cache misses per query. Cache misses
+ * are read with perf_event_open and reported as "n/a" when the
+ * counter is not available (non Linux hosts, containers, or a
+ * restrictive perf_event_paranoid setting).
+ *
+ * usage: reorder_bench [side] [queries]
+ */
+
+class cache_miss_counter
+{
+  public:
+    cache_miss_counter()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~cache_miss_counter()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+#endif
+    }
+
+    bool available() const { return m_fd >= 0; }
+
+    void start()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop()
+    {
+        long long count = 0;
+#ifdef __linux__
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+            {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+  private:
+    int m_fd = -1;
+};
+
+static void run(const std::string &name, const shortestPath &sp,
+                const std::vector<int> &sources,
+                const std::vector<int> &reference)
+{
+    cache_miss_counter counter;
+    counter.start();
+    auto begin = std::chrono::steady_clock::now();
+
+    long long checksum = 0;
+    for (int s : sources)
+    {
+        auto dist = sp.compute(s);
+        checksum += dist[dist.size() / 2];
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    long long misses = counter.stop();
+
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::cout << name << "\t" << ms / sources.size() << " ms/query\t";
+    if (counter.available())
+    {
+        std::cout << misses / static_cast<long long>(sources.size()) << " misses/query";
+    }
+    else
+    {
+        std::cout << "n/a misses/query";
+    }
+
+    // every ordering must give the same distances as the original
+    std::cout << (sp.compute(sources[0]) == reference ? "" : "\tMISMATCH")
+              << "\t(checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 20;
+    int n = side * side;
+
+    // random labels for the grid cells, as they would come out of an
+    // arbitrary data source.
+    std::mt19937 rng(42);
+    std::vector<int> label(n);
+    for (int i = 0; i < n; ++i)
+    {
+        label[i] = i;
+    }
+    std::shuffle(label.begin(), label.end(), rng);
+
+    std::uniform_int_distribution<int> weight(1, 100);
+    undirected_weighted_graph g(n);
+    std::vector<std::pair<double, double>> coordinates(n);
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            int cell = y * side + x;
+            coordinates[label[cell]] = std::make_pair(x, y);
+            if (x + 1 < side)
+            {
+                g.addEdge(label[cell], label[cell + 1], weight(rng));
+            }
+            if (y + 1 < side)
+            {
+                g.addEdge(label[cell], label[cell + side], weight(rng));
+            }
+        }
+    }
+
+    std::vector<int> sources(queries);
+    for (auto &s : sources)
+    {
+        s = rng() % n;
+    }
+
+    std::cout << side << "x" << side << " grid, " << g.countEdges()
+              << " edges, " << queries << " queries" << std::endl;
+
+    csr_graph csr(g);
+    shortestPath original(g);
+    auto reference = original.compute(sources[0]);
+
+    run("original", original, sources, reference);
+    run("bfs     ", shortestPath(g, bfsOrder(csr)), sources, reference);
+    run("rcm     ", shortestPath(g, reverseCuthillMcKee(csr)), sources, reference);
+    run("hilbert ", shortestPath(g, hilbertOrder(coordinates)), sources, reference);
+    return 0;
+}
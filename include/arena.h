@@ -0,0 +1,143 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*
+ * A pool arena for the many small, equally sized nodes of the
+ * std::map/std::set based graph containers.
+ *
+ * Memory is carved out of large blocks with a bump pointer, and
+ * freed nodes are kept on one free list per size class (multiples of
+ * 16 bytes up to 256 bytes) to be reused by later allocations of the
+ * same size. Requests that are larger than that go straight to the
+ * global operator new. Blocks are only given back to the system when
+ * the arena itself is destroyed. Destroying a graph still returns its
+ * nodes one at a time, but each one is a push on a free list instead
+ * of a call into the system allocator.
+ *
+ * An arena is not thread safe, all the containers sharing one must
+ * be used from a single thread at a time.
+ */
+class arena
+{
+  public:
+    arena(std::size_t blockBytes = 64 * 1024);
+
+    ~arena();
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t alignment);
+
+    void deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept;
+
+    // bytes obtained from the system for the blocks
+    std::size_t bytesReserved() const;
+
+    // bytes currently handed out to the containers
+    std::size_t bytesInUse() const;
+
+  private:
+    static const std::size_t granularity = 16;
+    static const std::size_t maxPooledSize = 256;
+
+    struct free_node
+    {
+        free_node *next;
+    };
+
+    std::vector<void *> m_blocks;
+    std::vector<free_node *> m_freeLists;
+    char *m_cursor;
+    char *m_end;
+    std::size_t m_blockBytes;
+    std::size_t m_reserved;
+    std::size_t m_inUse;
+
+    static bool pooled(std::size_t bytes, std::size_t alignment);
+};
+
+/*
+ * Standard allocator adaptor for `arena`. A default constructed
+ * allocator (no arena) falls back to the global operator new/delete,
+ * so the containers behave exactly like the std::allocator ones.
+ *
+ * The allocator shares the ownership of its arena, so the arena
+ * lives as long as any container (or copy of a container) that may
+ * still return nodes to it.
+ */
+template <class T>
+class arena_allocator
+{
+  public:
+    typedef T value_type;
+
+    arena_allocator() noexcept : m_arena(nullptr) {}
+
+    arena_allocator(std::shared_ptr<arena> pool) noexcept : m_arena(pool) {}
+
+    template <class U>
+    arena_allocator(const arena_allocator<U> &other) noexcept : m_arena(other.shared())
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        if (!m_arena)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        if (!m_arena)
+        {
+            ::operator delete(p);
+            return;
+        }
+        m_arena->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    arena *resource() const noexcept { return m_arena.get(); }
+
+    const std::shared_ptr<arena> &shared() const noexcept { return m_arena; }
+
+  private:
+    std::shared_ptr<arena> m_arena;
+};
+
+template <class T, class U>
+bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b) noexcept
+{
+    return a.resource() == b.resource();
+}
+
+template <class T, class U>
+bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b) noexcept
+{
+    return a.resource() != b.resource();
+}
+
+inline std::size_t arena::bytesReserved() const
+{
+    return m_reserved;
+}
+
+inline std::size_t arena::bytesInUse() const
+{
+    return m_inUse;
+}
+
+inline bool arena::pooled(std::size_t bytes, std::size_t alignment)
+{
+    return bytes <= maxPooledSize && alignment <= granularity;
+}
+
+#endif /* ifndef ARENA_H */
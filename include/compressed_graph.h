@@ -0,0 +1,190 @@
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+#include "../include/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * A compressed, read-only adjacency list representation of a weighted
+ * graph, for graphs too large to keep as a std::map of std::sets or
+ * even as a plain CSR.
+ *
+ * All the rows are stored back to back in a single byte array, and
+ * an offset array gives the start of the row of every vertex. A row
+ * is laid out as :-
+ *
+ * (1) the degree of the vertex, as a varint.
+ * (2) if the row has more than `blockSize` edges, a skip table with
+ *     one fixed width entry per block after the first one:
+ *     <first target of the block, byte offset of the block>.
+ * (3) the edges, sorted by target and split in blocks of `blockSize`
+ *     edges. Every edge is a varint target delta followed by a zigzag
+ *     varint weight. The first target of the row is stored relative
+ *     to the vertex itself (small once the graph has been reordered,
+ *     see graph_reorder.h), every other target relative to the one
+ *     before it, and the first target of later blocks is taken from
+ *     the skip table so that each block can be decoded on its own.
+ *
+ * Rows are decoded on the fly while iterating the neighbours, so
+ * shortestPath can run directly on this representation.
+ */
+
+class compressed_graph
+{
+  public:
+    static const int blockSize = 64;
+
+    compressed_graph();
+
+    explicit compressed_graph(const graph &g);
+
+    explicit compressed_graph(const csr_graph &g);
+
+    ~compressed_graph() = default;
+
+    /*
+     * Appends the out-edges of the next vertex (vertex number
+     * `countVertices()`). `row` is a list of <target, weight> pairs
+     * and is sorted in place. This lets huge graphs be compressed
+     * one row at a time without building another representation
+     * first. Targets may refer to vertices whose rows are appended
+     * later, but throws std::out_of_range for a negative one.
+     */
+    void appendRow(std::vector<std::pair<int, int>> &row);
+
+    int countVertices() const;
+
+    std::size_t countEdges() const;
+
+    // largest target of all the rows, -1 if there are no edges
+    int maxTarget() const;
+
+    int degree(int vertex) const;
+
+    /*
+     * Calls `f(target, weight)` for every out-edge of `vertex`, in
+     * increasing order of target.
+     */
+    template <class Function>
+    void forEachNeighbour(int vertex, Function f) const;
+
+    /*
+     * Looks up the edge `source -> dest` using the skip table, and
+     * stores the smallest weight among the parallel edges in
+     * `weight`. Returns false if there is no such edge.
+     */
+    bool findEdge(int source, int dest, int &weight) const;
+
+    // size of the encoded rows and of the row offsets, in bytes
+    std::size_t memoryUsage() const;
+
+    // binary serialization, return false on I/O or format errors
+    bool write(const std::string &filename) const;
+
+    bool read(const std::string &filename);
+
+  private:
+    std::vector<std::uint64_t> m_offsets;
+    std::vector<unsigned char> m_data;
+    std::size_t m_edges;
+    int m_maxTarget;
+
+    // decoder state for the start of a row
+    const unsigned char *rowBegin(int vertex, std::uint32_t &degree) const;
+
+    // decodes a row with bounds checks, for the rows of a file that
+    // is read back; adds the degree of the row to `edges` and raises
+    // `maxTarget` to its largest target.
+    bool validRow(int vertex, std::size_t &edges, int &maxTarget) const;
+
+    static std::uint32_t readVarint(const unsigned char *&p);
+    static bool readVarint(const unsigned char *&p, const unsigned char *end, std::uint32_t &value);
+    static std::uint32_t readFixed(const unsigned char *p);
+    static int unzigzag(std::uint32_t value);
+};
+
+inline int compressed_graph::countVertices() const
+{
+    return m_offsets.size() - 1;
+}
+
+inline std::size_t compressed_graph::countEdges() const
+{
+    return m_edges;
+}
+
+inline int compressed_graph::maxTarget() const
+{
+    return m_maxTarget;
+}
+
+inline std::uint32_t compressed_graph::readVarint(const unsigned char *&p)
+{
+    std::uint32_t value = *p & 0x7f;
+    int shift = 7;
+    while (*p++ & 0x80)
+    {
+        value |= static_cast<std::uint32_t>(*p & 0x7f) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+inline std::uint32_t compressed_graph::readFixed(const unsigned char *p)
+{
+    return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+           static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+}
+
+inline int compressed_graph::unzigzag(std::uint32_t value)
+{
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+inline const unsigned char *compressed_graph::rowBegin(int vertex, std::uint32_t &degree) const
+{
+    const unsigned char *p = m_data.data() + m_offsets[vertex];
+    degree = readVarint(p);
+    return p;
+}
+
+template <class Function>
+void compressed_graph::forEachNeighbour(int vertex, Function f) const
+{
+    std::uint32_t degree;
+    const unsigned char *p = rowBegin(vertex, degree);
+    if (degree == 0)
+    {
+        return;
+    }
+
+    // the blocks follow the skip table, and are decoded in sequence
+    // so the table itself is not needed here.
+    std::uint32_t blocks = (degree + blockSize - 1) / blockSize;
+    const unsigned char *skip = p;
+    p += 8 * (blocks - 1);
+
+    int target = vertex;
+    for (std::uint32_t i = 0; i < degree; ++i)
+    {
+        if (i == 0)
+        {
+            target += unzigzag(readVarint(p));
+        }
+        else if (i % blockSize == 0)
+        {
+            target = readFixed(skip + 8 * (i / blockSize - 1));
+        }
+        else
+        {
+            target += readVarint(p);
+        }
+        f(target, unzigzag(readVarint(p)));
+    }
+    return;
+}
+
+#endif /* ifndef COMPRESSED_GRAPH_H */
@@ -0,0 +1,103 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "../include/graph.h"
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+class vertex_ordering;
+
+/*
+ * A read-only compressed sparse row (CSR) representation of a
+ * weighted graph. The out-edges of vertex `v` occupy the half open
+ * range [offsets[v], offsets[v + 1]) of two parallel arrays, one
+ * holding the target vertices and one holding the edge weights.
+ *
+ * Keeping targets and weights in separate contiguous arrays lets the
+ * shortest path relaxation loop gather `distances[targets[i]]` with
+ * vector instructions instead of chasing tree nodes.
+ *
+ * Vertices are indexed by their label, so the number of vertex slots
+ * is one more than the largest label in the source graph. Labels
+ * that never appeared in the source graph simply have no out-edges.
+ *
+ * A csr_graph can also be built as a relabeled copy of another one
+ * (see graph_reorder.h), which moves vertices that are visited
+ * together next to each other in memory.
+ */
+
+class csr_graph
+{
+  public:
+    csr_graph() = default;
+
+    csr_graph(const graph &g);
+
+    csr_graph(const std::map<int, std::set<std::pair<int, int>>> &adjList);
+
+    // copy of `g` with vertex `v` renamed to `order.toInternal(v)`
+    csr_graph(const csr_graph &g, const vertex_ordering &order);
+
+    csr_graph(const csr_graph &) = default;
+
+    ~csr_graph() = default;
+
+    int countVertices() const;
+
+    std::size_t countEdges() const;
+
+    int degree(int vertex) const;
+
+    // position of the first out-edge of `vertex` in the edge arrays,
+    // for callers that keep their own per edge data.
+    std::size_t firstEdge(int vertex) const;
+
+    // pointers to the first target/weight of the out-edges of `vertex`
+    const int *targets(int vertex) const;
+
+    const int *weights(int vertex) const;
+
+    // the graph with every edge reversed
+    csr_graph reversed() const;
+
+  private:
+    std::vector<std::size_t> m_offsets;
+    std::vector<int> m_targets;
+    std::vector<int> m_weights;
+};
+
+inline int csr_graph::countVertices() const
+{
+    return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+}
+
+inline std::size_t csr_graph::countEdges() const
+{
+    return m_targets.size();
+}
+
+inline int csr_graph::degree(int vertex) const
+{
+    return m_offsets[vertex + 1] - m_offsets[vertex];
+}
+
+inline std::size_t csr_graph::firstEdge(int vertex) const
+{
+    return m_offsets[vertex];
+}
+
+inline const int *csr_graph::targets(int vertex) const
+{
+    return m_targets.data() + m_offsets[vertex];
+}
+
+inline const int *csr_graph::weights(int vertex) const
+{
+    return m_weights.data() + m_offsets[vertex];
+}
+
+#endif /* ifndef CSR_GRAPH_H */
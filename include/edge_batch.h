@@ -0,0 +1,31 @@
+#ifndef EDGE_BATCH_H
+#define EDGE_BATCH_H
+
+#include "../include/graph.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * Helpers for the bulk `addEdges` of the graph classes.
+ *
+ * Instead of three tree operations per edge (two vertex lookups and a
+ * set insertion), the edges are first sorted and deduplicated as a
+ * flat array, and then appended to the adjacency list in order, so
+ * that every vertex and set insertion gets an exact position hint.
+ */
+
+/*
+ * Sorts the edges by <source, dest, weight> (in parallel for large
+ * batches) and removes exact duplicates.
+ */
+void sortEdges(std::vector<weighted_edge> &edges);
+
+/*
+ * Inserts the edges, sorted by `sortEdges`, into the adjacency list,
+ * creating the source and destination vertices that are missing.
+ * Returns the number of adjacency entries that were not already
+ * present.
+ */
+std::size_t insertSortedEdges(adjacency_map &adjList, const std::vector<weighted_edge> &edges);
+
+#endif /* ifndef EDGE_BATCH_H */
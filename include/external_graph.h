@@ -0,0 +1,210 @@
+#ifndef EXTERNAL_GRAPH_H
+#define EXTERNAL_GRAPH_H
+
+#include "../include/compressed_graph.h"
+#include "../include/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * A read-only adjacency list that stays on disk, for graphs that do
+ * not fit in memory even compressed. shortestPath runs on it with
+ * only the distances and the heap in memory.
+ *
+ * The file holds a 64 byte header, the edge offset of every vertex
+ * (uint64) and then the edges as <target, weight> int32 pairs, all in
+ * native byte order. It is read with pread in blocks of `blockBytes`,
+ * which are kept in an LRU cache of `cacheBytes`. No value straddles
+ * two blocks. Since the search jumps around the file, the kernel's
+ * sequential readahead is turned off; instead `prefetch` asks the
+ * kernel (posix_fadvise) to start reading the blocks of a vertex
+ * about to be settled, while the search works on the current one.
+ *
+ * Several searches may run on the same external_graph at once: the
+ * block cache is guarded by a mutex, and the edges are copied out of
+ * it in small chunks that are decoded once the lock is released. Only
+ * `open` must not run concurrently with anything else.
+ */
+class external_graph
+{
+  public:
+    struct io_stats
+    {
+        // block lookups answered by the cache, and the ones that
+        // needed a pread
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t bytesRead;
+        std::uint64_t evictions;
+        // readahead requests issued to the kernel
+        std::uint64_t prefetches;
+    };
+
+    external_graph(std::size_t cacheBytes = 64 << 20, std::size_t blockBytes = 64 << 10);
+
+    ~external_graph();
+
+    external_graph(const external_graph &) = delete;
+    external_graph &operator=(const external_graph &) = delete;
+
+    // write a graph in the on-disk format, return false on I/O errors
+    static bool write(const std::string &filename, const csr_graph &g);
+
+    static bool write(const std::string &filename, const compressed_graph &g);
+
+    // opens a file written by `write`, returns false on I/O or format
+    // errors.
+    bool open(const std::string &filename);
+
+    int countVertices() const;
+
+    std::size_t countEdges() const;
+
+    /*
+     * Calls `f(target, weight)` for every out-edge of `vertex`, in the
+     * order they were written. Throws std::runtime_error if reading
+     * the file fails, or if the row turns out to be corrupt (offsets
+     * out of order or past the edges, targets out of range): `open`
+     * only checks the header, the rows are checked as they are
+     * decoded.
+     */
+    template <class Function>
+    void forEachNeighbour(int vertex, Function f);
+
+    // starts reading the blocks of `vertex` in the background
+    void prefetch(int vertex);
+
+    io_stats stats() const;
+
+    void resetStats();
+
+  private:
+    // edges copied out of the cache per lock, see forEachNeighbour
+    static const int chunkEdges = 512;
+
+    struct cached_block
+    {
+        std::uint64_t index;
+        std::vector<unsigned char> data;
+    };
+
+    int m_fd;
+    std::size_t m_blockBytes;
+    std::size_t m_capacity;
+    std::uint64_t m_fileBytes;
+    int m_vertices;
+    std::uint64_t m_edges;
+    std::uint64_t m_edgesBegin;
+
+    // most recently used first
+    std::list<cached_block> m_lru;
+    std::unordered_map<std::uint64_t, std::list<cached_block>::iterator> m_blocks;
+    // blocks a readahead was requested for, and not read since
+    std::unordered_set<std::uint64_t> m_advised;
+    io_stats m_stats;
+    // guards the cache, the readahead requests and the stats
+    mutable std::mutex m_mutex;
+
+    // the block is only valid while m_mutex is held, and until the
+    // next call
+    const unsigned char *block(std::uint64_t index);
+
+    // reads the value at byte `position` of the file
+    template <class T>
+    T read(std::uint64_t position);
+
+    // edge index of the first out-edge of `vertex`
+    std::uint64_t edgeOffset(int vertex);
+
+    // whether the offsets of a row are in order and inside the edges
+    bool validRange(std::uint64_t begin, std::uint64_t end) const;
+
+    void advise(std::uint64_t index);
+
+    void close();
+};
+
+inline int external_graph::countVertices() const
+{
+    return m_vertices;
+}
+
+inline std::size_t external_graph::countEdges() const
+{
+    return m_edges;
+}
+
+inline external_graph::io_stats external_graph::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+template <class T>
+T external_graph::read(std::uint64_t position)
+{
+    T value;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const unsigned char *data = block(position / m_blockBytes);
+    std::memcpy(&value, data + position % m_blockBytes, sizeof(T));
+    return value;
+}
+
+inline std::uint64_t external_graph::edgeOffset(int vertex)
+{
+    return read<std::uint64_t>(64 + 8 * static_cast<std::uint64_t>(vertex));
+}
+
+inline bool external_graph::validRange(std::uint64_t begin, std::uint64_t end) const
+{
+    return begin <= end && end <= m_edges;
+}
+
+template <class Function>
+void external_graph::forEachNeighbour(int vertex, Function f)
+{
+    std::uint64_t first = edgeOffset(vertex), last = edgeOffset(vertex + 1);
+    if (!validRange(first, last))
+    {
+        throw std::runtime_error("external_graph: corrupt edge offsets");
+    }
+    std::uint64_t position = m_edgesBegin + 8 * first;
+    std::uint64_t end = m_edgesBegin + 8 * last;
+
+    // copy the row out of the cache one chunk at a time, and decode
+    // it without the lock: another search may evict the block in the
+    // meantime, and `f` is not kept waiting on the other searches.
+    std::int32_t edges[2 * chunkEdges];
+    while (position < end)
+    {
+        std::uint64_t index = position / m_blockBytes;
+        std::uint64_t blockBegin = index * m_blockBytes;
+        std::uint64_t chunkEnd = std::min<std::uint64_t>(end, blockBegin + m_blockBytes);
+        chunkEnd = std::min<std::uint64_t>(chunkEnd, position + sizeof(edges));
+        std::size_t bytes = chunkEnd - position;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::memcpy(edges, block(index) + (position - blockBegin), bytes);
+        }
+        for (std::size_t i = 0; i < bytes / 8; ++i)
+        {
+            if (edges[2 * i] < 0 || edges[2 * i] >= m_vertices)
+            {
+                throw std::runtime_error("external_graph: edge target out of range");
+            }
+            f(edges[2 * i], edges[2 * i + 1]);
+        }
+        position = chunkEnd;
+    }
+    return;
+}
+
+#endif /* ifndef EXTERNAL_GRAPH_H */
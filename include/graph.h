@@ -1,25 +1,166 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "../include/arena.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
+// Containers used by the mutable graph classes. They allocate
+// through an arena_allocator, which is backed by an arena if one was
+// given to the graph and by the global heap otherwise.
+typedef std::pair<int, int> adjacency_entry;
+typedef std::set<adjacency_entry, std::less<adjacency_entry>,
+                 arena_allocator<adjacency_entry>>
+    adjacency_set;
+typedef std::map<int, adjacency_set, std::less<int>,
+                 arena_allocator<std::pair<const int, adjacency_set>>>
+    adjacency_map;
+
+struct weighted_edge
+{
+    int source;
+    int dest;
+    int weight;
+};
+
+/*
+ * Memory used by a graph, in bytes :-
+ * (1) adjacency :- the nodes of the adjacency sets, one per edge
+ *     entry.
+ * (2) index :- the nodes of the vertex map, including the set
+ *     headers they hold.
+ * (3) auxiliary :- the graph object itself, and the blocks of its
+ *     arena (if any) that are reserved but not handed out. An arena
+ *     shared by copies of a graph is reported by each of them.
+ * Node sizes are estimated from the container layout, rounded up to
+ * the 16 byte granularity of both the arena and the system malloc.
+ */
+struct graph_memory
+{
+    std::size_t adjacency;
+    std::size_t index;
+    std::size_t auxiliary;
+
+    std::size_t total() const { return adjacency + index + auxiliary; }
+};
+
 class graph
 {
   public:
+    graph() = default;
+    graph(const graph &other);
+    graph &operator=(const graph &other);
     virtual ~graph() = default;
 
     virtual void addVertex(int v) = 0;
     virtual void removeVertex(int v) = 0;
     virtual void addEdge(int src, int dest, int weight) = 0;
+    // same result as calling addEdge for every element, in bulk
+    virtual void addEdges(const std::vector<weighted_edge> &edges) = 0;
+    template <class Iterator>
+    void addEdges(Iterator first, Iterator last);
     virtual void removeEdge(int src, int dest) = 0;
+    // both O(1), the counts are maintained by the modifications
     virtual int countVertices() = 0;
-    virtual int countEdges() = 0;
+    virtual std::size_t countEdges() = 0;
+    virtual graph_memory memoryUsage() const = 0;
     virtual bool writeDot(std::string filename) = 0;
     virtual std::map<int, std::set<std::pair<int, int>>>
     getAdjacencyList() const = 0;
+
+    /*
+     * Number of modifications made to the graph so far. Every call
+     * that adds or removes vertices or edges increments it, so that
+     * results derived from the graph (see path_cache.h) can detect
+     * that they are stale. Safe to read from any thread.
+     */
+    std::uint64_t version() const;
+
+  protected:
+    void bumpVersion();
+
+    // erases the entries to `dest` from `entries`, returns how many
+    static std::size_t eraseEntries(adjacency_set &entries, int dest);
+
+    // memory report of an adjacency list with `entries` set nodes,
+    // for a graph object of `objectBytes` bytes.
+    static graph_memory adjacencyMemory(const adjacency_map &adjList, std::size_t entries,
+                                        std::size_t objectBytes);
+
+  private:
+    std::atomic<std::uint64_t> m_version{0};
 };
 
+inline graph::graph(const graph &other) : m_version(other.version())
+{
+}
+
+inline graph &graph::operator=(const graph &other)
+{
+    // the assigned graph changes, so it gets a new version as well
+    m_version.store(std::max(version(), other.version()) + 1);
+    return *this;
+}
+
+inline std::uint64_t graph::version() const
+{
+    return m_version.load(std::memory_order_acquire);
+}
+
+inline void graph::bumpVersion()
+{
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+inline std::size_t graph::eraseEntries(adjacency_set &entries, int dest)
+{
+    // the entries are sorted by destination, then weight, so the ones
+    // to `dest` form a single range.
+    auto first = entries.lower_bound(adjacency_entry(dest, std::numeric_limits<int>::min()));
+    auto last = first;
+    std::size_t count = 0;
+    while (last != entries.end() && last->first == dest)
+    {
+        ++last;
+        ++count;
+    }
+    entries.erase(first, last);
+    return count;
+}
+
+inline graph_memory graph::adjacencyMemory(const adjacency_map &adjList, std::size_t entries,
+                                           std::size_t objectBytes)
+{
+    // a red-black tree node is a color and three links, followed by
+    // the value
+    auto nodeBytes = [](std::size_t valueBytes) {
+        std::size_t bytes = 4 * sizeof(void *) + valueBytes;
+        return (bytes + 15) / 16 * 16;
+    };
+
+    graph_memory usage;
+    usage.adjacency = entries * nodeBytes(sizeof(adjacency_entry));
+    usage.index = adjList.size() * nodeBytes(sizeof(adjacency_map::value_type));
+    usage.auxiliary = objectBytes;
+    const arena *pool = adjList.get_allocator().resource();
+    if (pool)
+    {
+        usage.auxiliary += pool->bytesReserved() - pool->bytesInUse();
+    }
+    return usage;
+}
+
+template <class Iterator>
+void graph::addEdges(Iterator first, Iterator last)
+{
+    addEdges(std::vector<weighted_edge>(first, last));
+}
+
 #endif
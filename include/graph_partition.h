@@ -0,0 +1,31 @@
+#ifndef GRAPH_PARTITION_H
+#define GRAPH_PARTITION_H
+
+#include "../include/csr_graph.h"
+#include <vector>
+
+/*
+ * Splits the vertices of `g` into balanced cells of at most
+ * `maxCellSize` vertices each, with few edges between the cells.
+ *
+ * The cells come out of a recursive bisection: every part larger
+ * than `maxCellSize` is cut in two halves of equal size by growing a
+ * breadth first region from a pseudo-peripheral vertex of the part
+ * (edge directions are ignored), which tends to cut road like graphs
+ * along short fronts.
+ *
+ * Returns the cell of every vertex slot of `g`, cells are numbered
+ * from 0 in the order of the bisection.
+ */
+std::vector<int> partitionGraph(const csr_graph &g, int maxCellSize);
+
+/*
+ * Multilevel version of the above: one partition per entry of
+ * `cellSizes`, which must be increasing. The levels come out of the
+ * same bisection, so they are nested: every cell of a level is a
+ * union of cells of the level below it. Returns the cells of every
+ * vertex slot, level by level.
+ */
+std::vector<std::vector<int>> partitionGraph(const csr_graph &g, const std::vector<int> &cellSizes);
+
+#endif /* ifndef GRAPH_PARTITION_H */
@@ -0,0 +1,79 @@
+#ifndef GRAPH_REORDER_H
+#define GRAPH_REORDER_H
+
+#include "../include/csr_graph.h"
+#include <utility>
+#include <vector>
+
+/*
+ * A relabeling of the vertices of a graph. External labels are the
+ * ones the user built the graph with, internal labels are the
+ * positions the vertices get in the reordered (cache friendly)
+ * layout. Both directions of the permutation are kept so that the
+ * external labels stay stable for callers.
+ *
+ * A default constructed ordering is the identity.
+ */
+class vertex_ordering
+{
+  public:
+    vertex_ordering() = default;
+
+    // `order[i]` is the external label of the i-th internal vertex.
+    vertex_ordering(const std::vector<int> &order);
+
+    ~vertex_ordering() = default;
+
+    int toInternal(int external) const;
+
+    int toExternal(int internal) const;
+
+    int size() const;
+
+    bool empty() const;
+
+  private:
+    std::vector<int> m_toInternal;
+    std::vector<int> m_toExternal;
+};
+
+/*
+ * Orderings for graph layout. Each one visits every vertex slot of
+ * the graph exactly once; vertices unreachable from the start are
+ * appended component by component.
+ *
+ * (1) bfsOrder :- breadth first order from `root`.
+ * (2) reverseCuthillMcKee :- BFS from a pseudo-peripheral vertex that
+ *     visits neighbours by increasing degree, then reversed. Keeps
+ *     the bandwidth of the adjacency matrix low.
+ * (3) hilbertOrder :- sorts the vertices along a Hilbert curve over
+ *     their (x, y) coordinates, for graphs that have a geometry such
+ *     as road networks. `coordinates[v]` belongs to vertex `v`.
+ */
+vertex_ordering bfsOrder(const csr_graph &g, int root = 0);
+
+vertex_ordering reverseCuthillMcKee(const csr_graph &g);
+
+vertex_ordering hilbertOrder(const std::vector<std::pair<double, double>> &coordinates);
+
+inline int vertex_ordering::toInternal(int external) const
+{
+    return m_toInternal.empty() ? external : m_toInternal[external];
+}
+
+inline int vertex_ordering::toExternal(int internal) const
+{
+    return m_toExternal.empty() ? internal : m_toExternal[internal];
+}
+
+inline int vertex_ordering::size() const
+{
+    return m_toExternal.size();
+}
+
+inline bool vertex_ordering::empty() const
+{
+    return m_toExternal.empty();
+}
+
+#endif /* ifndef GRAPH_REORDER_H */
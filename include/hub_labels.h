@@ -0,0 +1,81 @@
+#ifndef HUB_LABELS_H
+#define HUB_LABELS_H
+
+#include "../include/csr_graph.h"
+#include "../include/directed_weighted_graph.h"
+#include "../include/undirected_weighted_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * An exact distance oracle based on hub labeling, built with pruned
+ * landmark labeling (PLL).
+ *
+ * Every vertex `v` gets an out-label, a list of <hub, d(v, hub)>, and
+ * an in-label, a list of <hub, d(hub, v)>, such that a shortest path
+ * from `s` to `t` always passes through a hub common to the
+ * out-label of `s` and the in-label of `t`. A distance query is then
+ * a merge join of two short sorted lists, with no graph search.
+ * Undirected graphs only need one label per vertex.
+ *
+ * Construction runs a pruned Dijkstra search from every vertex, in
+ * decreasing order of the number of sampled shortest paths through
+ * it (then of degree): the search from hub `h` stops at every
+ * vertex whose distance is already answered by the labels of the
+ * hubs before `h`. With more than one thread, the searches run in
+ * batches of `threads` hubs that only prune with the labels of the
+ * previous batches. The labels may then be slightly larger than
+ * with a single thread, but are just as exact.
+ *
+ * The labels can be saved to and loaded from a binary file, so that
+ * the (expensive) construction is done once per graph.
+ */
+class hub_labels
+{
+  public:
+    hub_labels() = default;
+
+    // `threads` = 0 uses one thread per hardware thread
+    hub_labels(const directed_weighted_graph &g, int threads = 0);
+
+    hub_labels(const undirected_weighted_graph &g, int threads = 0);
+
+    ~hub_labels() = default;
+
+    /*
+     * Returns the length of the shortest path from `source` to
+     * `target`, or std::numeric_limits<int>::max() if there is none,
+     * like shortestPath::compute.
+     */
+    int distance(int source, int target) const;
+
+    int countVertices() const;
+
+    // total number of <hub, distance> entries over all labels
+    std::size_t countEntries() const;
+
+    bool write(const std::string &filename) const;
+
+    bool read(const std::string &filename);
+
+  private:
+    // labels of vertex v are [offsets[v], offsets[v + 1]) of the
+    // hub/distance arrays, sorted by hub. Hubs are stored as ranks.
+    struct label_set
+    {
+        std::vector<std::uint64_t> offsets;
+        std::vector<int> hubs;
+        std::vector<int> distances;
+    };
+
+    bool m_symmetric = false;
+    label_set m_out;
+    // in-labels, unused (and empty) for undirected graphs
+    label_set m_in;
+
+    void build(const csr_graph &g, bool symmetric, int threads);
+};
+
+#endif /* ifndef HUB_LABELS_H */
@@ -0,0 +1,75 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/*
+ * Sorts `elems` with `comp` using up to `std::thread::hardware_concurrency`
+ * threads: the vector is split in equal chunks that are sorted
+ * concurrently, and the sorted chunks are then merged pairwise (also
+ * concurrently) until a single run is left. Small inputs are sorted
+ * on the calling thread.
+ */
+template <class T, class Compare = std::less<T>>
+void parallel_sort(std::vector<T> &elems, Compare comp = Compare())
+{
+    const std::size_t minChunk = 1 << 16;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, elems.size() / minChunk);
+    if (threads < 2)
+    {
+        std::sort(elems.begin(), elems.end(), comp);
+        return;
+    }
+
+    // boundaries of the chunks, chunk i is [bounds[i], bounds[i + 1])
+    std::vector<std::size_t> bounds;
+    for (std::size_t i = 0; i <= threads; ++i)
+    {
+        bounds.push_back(elems.size() * i / threads);
+    }
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&elems, &bounds, &comp, i]() {
+            std::sort(elems.begin() + bounds[i], elems.begin() + bounds[i + 1], comp);
+        });
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+
+    // merge neighbouring runs until one is left
+    while (bounds.size() > 2)
+    {
+        std::vector<std::size_t> merged;
+        workers.clear();
+        for (std::size_t i = 0; i + 2 < bounds.size(); i += 2)
+        {
+            merged.push_back(bounds[i]);
+            workers.emplace_back([&elems, &bounds, &comp, i]() {
+                std::inplace_merge(elems.begin() + bounds[i], elems.begin() + bounds[i + 1],
+                                   elems.begin() + bounds[i + 2], comp);
+            });
+        }
+        if (bounds.size() % 2 == 0)
+        {
+            // odd number of runs, the last one is carried over as is
+            merged.push_back(bounds[bounds.size() - 2]);
+        }
+        merged.push_back(bounds.back());
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+        bounds.swap(merged);
+    }
+    return;
+}
+
+#endif /* ifndef PARALLEL_SORT_H */
@@ -0,0 +1,151 @@
+#ifndef PARTITION_OVERLAY_H
+#define PARTITION_OVERLAY_H
+
+#include "../include/csr_graph.h"
+#include "../include/search_workspace.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * A customizable route planning (CRP) style multilevel overlay, for
+ * graphs whose topology is fixed but whose edge weights change often
+ * (traffic).
+ *
+ * Preprocessing is split in two phases :-
+ *
+ * (1) the metric independent phase partitions the vertices into
+ *     nested levels of balanced cells (see graph_partition.h) and
+ *     finds the boundary vertices of every cell, the ones with an
+ *     edge to or from another cell of the same level. It only
+ *     depends on the topology and is done once.
+ * (2) the customization phase computes, for every cell, the clique
+ *     of shortest path distances between its boundary vertices. The
+ *     cells of the lowest level are searched on the original edges,
+ *     the cells of higher levels on the cliques of their subcells,
+ *     so every level is cheap to build from the one below. Cells of
+ *     a level are independent and are customized in parallel, and
+ *     after a weight change only the cells containing changed edges
+ *     are recomputed.
+ *
+ * A query runs Dijkstra on the original edges of the lowest level
+ * cells of the source and target. Any other vertex is crossed
+ * through the clique of its highest level cell that contains neither
+ * endpoint, so the search settles few vertices far from the
+ * endpoints.
+ */
+class partition_overlay
+{
+  public:
+    // `threads` = 0 uses one thread per hardware thread, the default
+    // cell sizes are 2^8, 2^11 and 2^14 vertices.
+    partition_overlay(const graph &g, int threads = 0);
+
+    partition_overlay(const csr_graph &g, int threads = 0);
+
+    // `cellSizes` are the maximum cell sizes of the levels, from the
+    // lowest one up, and must be increasing.
+    partition_overlay(const csr_graph &g, const std::vector<int> &cellSizes, int threads = 0);
+
+    ~partition_overlay() = default;
+
+    /*
+     * Returns the length of the shortest path from `source` to
+     * `target` for the customized metric, or
+     * std::numeric_limits<int>::max() if there is none. Throws
+     * std::out_of_range for vertices not in the graph. Queries must
+     * not run concurrently with `updateWeight` and `customize`.
+     */
+    int distance(int source, int target) const;
+
+    // same, reusing the scratch state of `workspace`
+    int distance(int source, int target, search_workspace &workspace) const;
+
+    /*
+     * Sets the weight of the edge `source -> dest` (of all the
+     * parallel ones) and marks its cells for customization. For
+     * undirected graphs, both directions must be updated. The new
+     * weight is only seen by the queries after `customize`. Returns
+     * false if there is no such edge.
+     */
+    bool updateWeight(int source, int dest, int weight);
+
+    // recomputes the cliques of the cells changed since the last
+    // customization, returns the number of cells recomputed.
+    int customize();
+
+    int countVertices() const;
+
+    int countLevels() const;
+
+    int countCells(int level) const;
+
+    int cellOf(int level, int vertex) const;
+
+    std::size_t countBoundaryVertices(int level) const;
+
+  private:
+    /*
+     * The cells of one level. The vertices of cell c are
+     * [cellOffsets[c], cellOffsets[c + 1]) of cellVertices, its
+     * boundary vertices [boundaryOffsets[c], boundaryOffsets[c + 1])
+     * of boundary, and boundaryIndex gives the position of a vertex
+     * within the boundary of its cell (-1 if inner). The clique of
+     * cell c is a row major b x b distance matrix starting at
+     * cliqueOffsets[c].
+     */
+    struct overlay_level
+    {
+        std::vector<int> cell;
+        std::vector<std::size_t> cellOffsets;
+        std::vector<int> cellVertices;
+        std::vector<std::size_t> boundaryOffsets;
+        std::vector<int> boundary;
+        std::vector<int> boundaryIndex;
+        std::vector<std::size_t> cliqueOffsets;
+        std::vector<int> clique;
+        std::vector<char> dirty;
+    };
+
+    csr_graph m_graph;
+    // weights of the current metric, by edge position in m_graph
+    std::vector<int> m_weights;
+    int m_threads;
+    std::vector<overlay_level> m_levels;
+
+    // Dijkstra from `source`, calls arcs(u, du, relax) for every
+    // settled vertex until `target` is settled.
+    template <class Arcs>
+    int search(int source, int target, search_workspace &workspace, Arcs arcs) const;
+
+    template <class Function>
+    void forEachCliqueArc(int level, int vertex, Function f) const;
+
+    void customizeCell(int level, int cell, search_workspace &workspace);
+};
+
+inline int partition_overlay::countVertices() const
+{
+    return m_graph.countVertices();
+}
+
+inline int partition_overlay::countLevels() const
+{
+    return m_levels.size();
+}
+
+inline int partition_overlay::countCells(int level) const
+{
+    return m_levels[level].cellOffsets.size() - 1;
+}
+
+inline int partition_overlay::cellOf(int level, int vertex) const
+{
+    return m_levels[level].cell[vertex];
+}
+
+inline std::size_t partition_overlay::countBoundaryVertices(int level) const
+{
+    return m_levels[level].boundary.size();
+}
+
+#endif /* ifndef PARTITION_OVERLAY_H */
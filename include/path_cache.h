@@ -0,0 +1,85 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include "../include/shortestPath.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * A bounded, thread safe LRU cache of single source shortest path
+ * results, for workloads where a few hot sources account for most of
+ * the queries.
+ *
+ * The cache is bound to a graph. It remembers the `version()` of the
+ * graph its entries were computed for, and drops all of them as soon
+ * as the graph reports a different version, i.e. after any
+ * addVertex/addEdge(s)/removeEdge/removeVertex. The graph must
+ * outlive the cache, and mutations of the graph still have to be
+ * synchronized with the queries by the caller, as for shortestPath.
+ *
+ * Results are returned as shared pointers to immutable vectors, so a
+ * hit costs a hash lookup and a list splice, and a result stays valid
+ * for its holder even after it has been evicted.
+ */
+class path_cache
+{
+  public:
+    struct metrics
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t evictions;
+        // number of times the cache was flushed by a graph change
+        std::uint64_t invalidations;
+        std::size_t entries;
+    };
+
+    path_cache(const graph &g, std::size_t capacity);
+    path_cache() = delete;
+    ~path_cache() = default;
+
+    /*
+     * Returns the distances from `source` to every vertex, like
+     * shortestPath::compute. Misses are computed without holding the
+     * lock, so concurrent misses for different sources run in
+     * parallel.
+     */
+    std::shared_ptr<const std::vector<int>> distances(int source);
+
+    metrics stats() const;
+
+    void clear();
+
+  private:
+    typedef std::shared_ptr<const std::vector<int>> result;
+    typedef std::list<int>::iterator lru_position;
+
+    const graph &m_graph;
+    std::size_t m_capacity;
+
+    mutable std::mutex m_mutex;
+    // serializes the builds of the solver, which copy the whole graph
+    // and so run outside of m_mutex
+    std::mutex m_buildMutex;
+    // graph version of the entries and of the solver
+    std::uint64_t m_version;
+    std::shared_ptr<const shortestPath> m_solver;
+    // sources from the most to the least recently used
+    std::list<int> m_lru;
+    std::unordered_map<int, std::pair<result, lru_position>> m_entries;
+    metrics m_metrics;
+
+    // both expect m_mutex to be held
+    void syncVersion();
+    void insert(int source, const result &distances);
+
+    // returns the solver of graph version `version`, building it if
+    // no other miss has done so yet; expects m_mutex not to be held.
+    std::shared_ptr<const shortestPath> buildSolver(std::uint64_t version);
+};
+
+#endif /* ifndef PATH_CACHE_H */
@@ -0,0 +1,84 @@
+#ifndef PROFILE_POOL_H
+#define PROFILE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * A shared pool of periodic, piecewise linear travel time profiles
+ * for time-dependent edge weights (rush hour).
+ *
+ * A profile is a list of <time, travel time> breakpoints over one
+ * period (a day by default); the travel time is interpolated linearly
+ * between consecutive breakpoints and wraps around from the last one
+ * to the first one of the next period. Profiles must be FIFO: leaving
+ * later never means arriving earlier, i.e. no segment has a slope
+ * below -1. This is what keeps a plain Dijkstra search exact on
+ * time-dependent weights.
+ *
+ * Edges refer to profiles by id, which is stored in the `int weight`
+ * of the adjacency entries, so a profile shared by many edges is
+ * stored once. Identical profiles are merged when they are added.
+ *
+ * The breakpoints of all the profiles are stored as two flat arrays
+ * (times and travel times) so that the breakpoint search of
+ * `evaluate` is a branchless, vectorizable scan.
+ */
+class profile_pool
+{
+  public:
+    // length of a day in seconds
+    static const int defaultPeriod = 24 * 60 * 60;
+
+    profile_pool(int period = defaultPeriod);
+    ~profile_pool() = default;
+
+    /*
+     * Adds a profile and returns its id, or the id of an identical
+     * profile already in the pool. `points` are <time, travel time>
+     * pairs with strictly increasing times in [0, period) and
+     * non-negative travel times. Throws std::invalid_argument if the
+     * profile is malformed or not FIFO.
+     */
+    int addProfile(const std::vector<std::pair<int, int>> &points);
+
+    // id of a profile with a constant travel time
+    int addConstant(int travelTime);
+
+    /*
+     * Travel time of `profile` when leaving at `time` (>= 0, taken
+     * modulo the period), rounded down.
+     */
+    int evaluate(int profile, int time) const;
+
+    int period() const;
+
+    int size() const;
+
+    // bytes used by the breakpoints and the profile offsets
+    std::size_t memoryUsage() const;
+
+  private:
+    int m_period;
+    // breakpoints of profile p are [m_offsets[p], m_offsets[p + 1])
+    std::vector<std::uint32_t> m_offsets;
+    std::vector<int> m_times;
+    std::vector<int> m_values;
+    // profile ids by hash of their breakpoints
+    std::unordered_multimap<std::uint64_t, int> m_index;
+};
+
+inline int profile_pool::period() const
+{
+    return m_period;
+}
+
+inline int profile_pool::size() const
+{
+    return m_offsets.size() - 1;
+}
+
+#endif /* ifndef PROFILE_POOL_H */
@@ -0,0 +1,157 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "../include/shortestPath.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A long lived shortest path query service: the graph is loaded into
+ * a single shortestPath solver once, and the queries are answered by
+ * a pool of worker threads.
+ *
+ * Requests are queued by source. A worker takes all the requests
+ * waiting for the oldest queued source at once, runs one single
+ * source search for the whole batch and completes them one by one,
+ * so concurrent requests sharing a source cost a single search.
+ * Completions are delivered asynchronously, on the worker thread,
+ * in no particular order.
+ *
+ * Besides the library interface (`submit`), the server speaks a line
+ * based text protocol over file descriptors, i.e. stdin/stdout pipes
+ * (`serve`) or the connections of a Unix domain socket (`serveUnix`).
+ * Each request line is one of :-
+ *
+ *   <id> <source>            distances to every vertex
+ *   <id> <source> <target>   distance to a single vertex
+ *   stats                    counters and latency histogram
+ *
+ * and is answered, as soon as it completes, by a line
+ * `<id> ok <distance>...` (unreachable vertices read `inf`) or
+ * `<id> error <message>`. The ids are chosen by the client to match
+ * the answers to the requests.
+ */
+class query_server
+{
+  public:
+    // number of latency histogram buckets, bucket i counts the
+    // requests that took [2^i, 2^(i + 1)) microseconds (bucket 0
+    // also counts the faster ones).
+    static const int latencyBuckets = 32;
+
+    struct request
+    {
+        std::uint64_t id;
+        int source;
+        // -1 to get the distances to every vertex
+        int target;
+    };
+
+    struct result
+    {
+        std::uint64_t id;
+        int source;
+        int target;
+        bool ok;
+        // distance to `target`, if one was given
+        int distance;
+        // distances to every vertex, shared by the whole batch
+        std::shared_ptr<const std::vector<int>> distances;
+        // reason of the failure when !ok
+        std::string error;
+    };
+
+    typedef std::function<void(const result &)> completion;
+
+    struct metrics
+    {
+        std::uint64_t requests;
+        std::uint64_t completed;
+        // number of searches run, requests / batches is the average
+        // batch size.
+        std::uint64_t batches;
+        std::size_t queueDepth;
+        std::size_t maxQueueDepth;
+        std::vector<std::uint64_t> latency;
+    };
+
+    // `threads` = 0 uses one worker per hardware thread
+    query_server(const graph &g, int threads = 0);
+
+    query_server(std::shared_ptr<const shortestPath> solver, int threads = 0);
+
+    // completes the queued requests before returning
+    ~query_server();
+
+    query_server(const query_server &) = delete;
+    query_server &operator=(const query_server &) = delete;
+
+    // queues `r`, `done` is called once from a worker thread
+    void submit(const request &r, completion done);
+
+    /*
+     * Reads request lines from `input` until end of file, and writes
+     * the answers to `output`. Returns once every request read has
+     * been answered, false if reading or writing failed.
+     */
+    bool serve(int input, int output);
+
+    /*
+     * Listens on a Unix domain socket at `path` and serves every
+     * connection as above, each on its own thread, until `stop()`.
+     * Returns false if the socket could not be set up.
+     */
+    bool serveUnix(const std::string &path);
+
+    // makes serveUnix return, after its connections are closed; if
+    // it is not listening yet, the next call returns right away.
+    void stop();
+
+    metrics stats() const;
+
+  private:
+    typedef std::chrono::steady_clock clock;
+
+    struct pending_request
+    {
+        request r;
+        completion done;
+        clock::time_point queued;
+    };
+
+    std::shared_ptr<const shortestPath> m_solver;
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    // sources in the order of their oldest request, and the requests
+    // waiting for each of them
+    std::deque<int> m_sources;
+    std::unordered_map<int, std::vector<pending_request>> m_pending;
+    metrics m_metrics;
+
+    // listening socket and open connections of serveUnix, guarded
+    // by m_mutex
+    bool m_listening;
+    // stop() was called, cleared when serveUnix returns
+    bool m_stopRequested;
+    int m_listener;
+    std::vector<int> m_connections;
+
+    void work();
+    void complete(const pending_request &p, const result &res);
+};
+
+#endif /* ifndef QUERY_SERVER_H */
@@ -0,0 +1,40 @@
+#ifndef RELAX_H
+#define RELAX_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+ * Edge relaxation kernels used by the shortest path computation.
+ *
+ * Given the settled distance `du` of a vertex and its out-edges as
+ * two parallel arrays, every target `v` with `du + weight < distances[v]`
+ * gets its distance lowered, and the new (distance, vertex) pair is
+ * appended to `improved` so that the caller can push it into the heap.
+ *
+ * Rows shorter than `relaxSimdThreshold` are handled with a plain
+ * scalar loop. Longer rows (high degree hubs) go through a vector
+ * kernel which gathers `distances[targets]`, adds the weights and
+ * compares them in 8 (AVX2) or 16 (AVX-512) lanes at a time. The
+ * kernel is chosen once at runtime from the features of the CPU, and
+ * falls back to the scalar loop on CPUs/compilers without them.
+ *
+ * The improved pairs are produced in exactly the same order as the
+ * scalar loop would produce them, so the result does not depend on
+ * the kernel that was selected.
+ */
+
+const std::size_t relaxSimdThreshold = 16;
+
+void relaxEdges(const int *targets, const int *weights, std::size_t count,
+                int du, int *distances,
+                std::vector<std::pair<int, int>> &improved);
+
+/*
+ * Returns the name of the kernel used for high degree vertices,
+ * one of "avx512", "avx2" or "scalar".
+ */
+const char *relaxKernelName();
+
+#endif /* ifndef RELAX_H */
@@ -0,0 +1,80 @@
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+
+#include "../include/heap.h"
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/*
+ * Reusable scratch state for the bounded searches of shortestPath
+ * (`computeWithin` and `computeNearest`).
+ *
+ * A bounded search typically touches a tiny part of the graph, so
+ * clearing a distance array of the size of the graph before every
+ * query would dominate its cost. Instead every entry carries the
+ * epoch of the search that wrote it, and starting a new search only
+ * increments the epoch: entries with an older epoch read as
+ * "infinity" / "not a target". The arrays are only (re)initialized
+ * when they need to grow, or once every 2^32 searches when the epoch
+ * wraps around.
+ *
+ * A workspace must not be shared by concurrent searches, keep one per
+ * thread.
+ */
+class search_workspace
+{
+  public:
+    search_workspace() = default;
+    ~search_workspace() = default;
+
+    // start a new search over a graph with `vertices` vertex slots
+    void reset(int vertices);
+
+    int distance(int vertex) const;
+
+    void setDistance(int vertex, int distance);
+
+    bool isTarget(int vertex) const;
+
+    void markTarget(int vertex);
+
+    heap<std::pair<int, int>> &queue();
+
+  private:
+    std::vector<int> m_distances;
+    std::vector<std::uint32_t> m_distanceEpoch;
+    std::vector<std::uint32_t> m_targetEpoch;
+    std::uint32_t m_epoch = 0;
+    heap<std::pair<int, int>> m_heap;
+};
+
+inline int search_workspace::distance(int vertex) const
+{
+    return m_distanceEpoch[vertex] == m_epoch ? m_distances[vertex]
+                                              : std::numeric_limits<int>::max();
+}
+
+inline void search_workspace::setDistance(int vertex, int distance)
+{
+    m_distances[vertex] = distance;
+    m_distanceEpoch[vertex] = m_epoch;
+}
+
+inline bool search_workspace::isTarget(int vertex) const
+{
+    return m_targetEpoch[vertex] == m_epoch;
+}
+
+inline void search_workspace::markTarget(int vertex)
+{
+    m_targetEpoch[vertex] = m_epoch;
+}
+
+inline heap<std::pair<int, int>> &search_workspace::queue()
+{
+    return m_heap;
+}
+
+#endif /* ifndef SEARCH_WORKSPACE_H */
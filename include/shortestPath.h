@@ -1,24 +1,110 @@
 #ifndef SHORTEST_PATH_H
 #define SHORTEST_PATH_H
 
+#include "../include/compressed_graph.h"
+#include "../include/csr_graph.h"
 #include "../include/directed_weighted_graph.h"
+#include "../include/external_graph.h"
+#include "../include/graph_reorder.h"
 #include "../include/heap.h"
+#include "../include/search_workspace.h"
 #include "../include/undirected_weighted_graph.h"
+#include "../include/versioned_graph.h"
+#include <memory>
+
+class profile_pool;
 
 /*
  * Implementation of the Dijkstra's shortest path algorithm
+ *
+ * The graph is copied into a contiguous CSR layout on construction,
+ * so that the edge relaxation of high degree vertices can run through
+ * the vectorized kernels in relax.h.
+ *
+ * Optionally a vertex_ordering can be given, in which case the CSR
+ * copy is laid out in that order for better cache locality. Sources
+ * and the returned distances still use the labels of the graph.
+ *
+ * A compressed_graph is not copied at all: the search decodes its
+ * rows on the fly, and the compressed graph must outlive the
+ * shortestPath object (so a temporary is rejected). All its targets
+ * must have a row; the constructor throws std::invalid_argument
+ * otherwise, and no rows may be appended afterwards. A graph_snapshot
+ * is not copied either, the shortestPath object holds a reference to
+ * it so that it stays alive while a newer version gets published. An
+ * external_graph stays on disk: compute keeps only the distances and
+ * the heap in memory, and reads ahead the rows of the vertices at the
+ * top of the heap, which are the next ones to be settled. It must
+ * outlive the shortestPath object; concurrent searches share its
+ * block cache.
+ *
+ * Besides the full single source computation, two bounded searches
+ * stop early and return a sparse list of <vertex, distance> pairs in
+ * increasing order of distance :-
+ * (1) computeWithin :- every vertex at distance at most `radius`.
+ * (2) computeNearest :- the `k` closest vertices, or the `k` closest
+ *     of a given list of targets. The source itself counts, at
+ *     distance 0, if it is one of the candidates.
+ * They keep their state in a search_workspace, so they cost time in
+ * proportion to the part of the graph they explore, not to its size.
+ *
+ * For time-dependent weights, the weights of the graph are taken as
+ * ids of travel time profiles in a profile_pool, and compute is given
+ * a departure time: every edge costs its travel time at the moment it
+ * is entered.
  */
 class shortestPath
 {
   public:
     shortestPath(const graph &g);
+    shortestPath(const graph &g, const vertex_ordering &order);
+    shortestPath(const compressed_graph &g);
+    shortestPath(const compressed_graph &&g) = delete;
+    shortestPath(std::shared_ptr<const graph_snapshot> snapshot);
+    shortestPath(external_graph &g);
+    shortestPath(external_graph &&g) = delete;
     shortestPath() = delete;
     ~shortestPath() = default;
 
     std::vector<int> compute(const int &source) const;
 
+    /*
+     * Earliest travel times from `source` when leaving at time
+     * `departure` (>= 0), with the weights of the graph read as
+     * profile ids in `profiles`. Throws std::out_of_range for a
+     * weight that is not a profile of the pool.
+     */
+    std::vector<int> compute(const int &source, int departure, const profile_pool &profiles) const;
+
+    std::vector<std::pair<int, int>> computeWithin(const int &source, int radius,
+                                                   search_workspace &workspace) const;
+
+    std::vector<std::pair<int, int>> computeNearest(const int &source, int k,
+                                                    search_workspace &workspace) const;
+
+    std::vector<std::pair<int, int>> computeNearest(const int &source, int k,
+                                                    const std::vector<int> &targets,
+                                                    search_workspace &workspace) const;
+
   private:
-    std::map<int, std::set<std::pair<int, int>>> m_graph;
+    csr_graph m_graph;
+    vertex_ordering m_order;
+    const compressed_graph *m_compressed;
+    external_graph *m_external;
+    std::shared_ptr<const graph_snapshot> m_snapshot;
+
+    int countVertices() const;
+
+    // calls `f(neighbours)` with the neighbour iteration of the
+    // representation in use, and returns its result; every search
+    // goes through it, see shortestPath.cpp.
+    template <class F>
+    auto withNeighbours(F f) const -> typename F::result_type;
+
+    // runs a bounded search from `source` over the (already reset)
+    // workspace, see shortestPath.cpp.
+    template <class Settle>
+    void boundedSearch(int source, search_workspace &workspace, Settle settle) const;
 };
 
 #endif /* ifndef SHORTEST_PATH_H */
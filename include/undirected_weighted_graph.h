@@ -7,6 +7,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -19,9 +20,18 @@
  *
  * This implementation also has basic facilities to :-
  * (1) add/remove vertices and edges.
- * (2) count the number of vertices and edges.
+ * (2) count the number of vertices and edges, in constant time.
  * (3) Write a dot file for graphViz to plot.
  * (4) Helper functions to get a list of edges.
+ * (5) Bulk insertion of edges, which sorts the whole batch once
+ *     instead of doing tree lookups for every edge.
+ * (6) Report the memory used by the graph, see graph_memory.
+ *
+ * The map and set nodes can be allocated from an `arena` (see
+ * arena.h) shared by the graph and its copies, which turns the one
+ * heap allocation per vertex and per edge into a bump of a pointer,
+ * and releases them all at once when the last graph using the arena
+ * is destroyed.
  */
 
 class undirected_weighted_graph : public graph
@@ -31,6 +41,10 @@ class undirected_weighted_graph : public graph
 
     undirected_weighted_graph(int vertices);
 
+    undirected_weighted_graph(std::shared_ptr<arena> pool);
+
+    undirected_weighted_graph(int vertices, std::shared_ptr<arena> pool);
+
     virtual ~undirected_weighted_graph() = default;
 
     virtual void addVertex(int vertex) override;
@@ -39,11 +53,16 @@ class undirected_weighted_graph : public graph
 
     virtual void addEdge(int source, int dest, int weight) override;
 
+    using graph::addEdges;
+    virtual void addEdges(const std::vector<weighted_edge> &edges) override;
+
     virtual void removeEdge(int source, int edge) override;
 
     virtual int countVertices() override;
 
-    virtual int countEdges() override;
+    virtual std::size_t countEdges() override;
+
+    virtual graph_memory memoryUsage() const override;
 
     virtual bool writeDot(std::string filename) override;
 
@@ -56,7 +75,9 @@ class undirected_weighted_graph : public graph
     friend std::ostream &operator<<(std::ostream &oss, const undirected_weighted_graph &graph);
 
   private:
-    std::map<int, std::set<std::pair<int, int>>> m_adjList;
+    adjacency_map m_adjList;
+    // number of entries in the adjacency sets
+    std::size_t m_entries = 0;
 };
 
 #endif /* ifndef UNDIRECTED_GRAPH_H */
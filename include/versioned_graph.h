@@ -0,0 +1,185 @@
+#ifndef VERSIONED_GRAPH_H
+#define VERSIONED_GRAPH_H
+
+#include "../include/directed_weighted_graph.h"
+#include "../include/undirected_weighted_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+/*
+ * An immutable version of a graph, as published by versioned_graph.
+ *
+ * The edge lists are grouped in chunks of `chunkSize` vertices, and
+ * both the chunks and the lists are shared (through shared_ptr) with
+ * the previous and next versions: publishing a change copies only
+ * the list of pointers to the chunks, the chunks that contain a
+ * modified vertex, and the modified lists themselves.
+ *
+ * A snapshot never changes once published, so any number of threads
+ * can query it without synchronization for as long as they hold it.
+ */
+class graph_snapshot
+{
+  public:
+    // pairs of <target, weight> sorted like the std::set of the
+    // mutable graph classes.
+    typedef std::vector<std::pair<int, int>> edge_list;
+
+    static const int chunkBits = 8;
+    static const int chunkSize = 1 << chunkBits;
+
+    graph_snapshot() = default;
+    ~graph_snapshot() = default;
+
+    // number of vertex slots, one more than the largest vertex label
+    int countVertices() const;
+
+    std::size_t countEdges() const;
+
+    std::uint64_t version() const;
+
+    bool hasVertex(int vertex) const;
+
+    // out-edges of `vertex`, empty for vertices not in the graph
+    const edge_list &edges(int vertex) const;
+
+    template <class Function>
+    void forEachNeighbour(int vertex, Function f) const;
+
+  private:
+    friend class versioned_graph;
+
+    // a null list marks a vertex slot that is not in the graph
+    typedef std::vector<std::shared_ptr<const edge_list>> chunk;
+
+    std::vector<std::shared_ptr<const chunk>> m_chunks;
+    int m_vertices = 0;
+    std::size_t m_entries = 0;
+    bool m_directed = true;
+    std::uint64_t m_version = 0;
+
+    const std::shared_ptr<const edge_list> &list(int vertex) const;
+};
+
+/*
+ * A graph for one writer and many concurrent readers.
+ *
+ * Readers call `snapshot()` to get the current version, a shared
+ * pointer to an immutable graph_snapshot that they can query (for
+ * instance with shortestPath) without any lock, while the writer
+ * keeps modifying the graph.
+ *
+ * The writer stages a batch of modifications with the same calls as
+ * the mutable graph classes, and makes the whole batch visible at
+ * once with `publish()`, which builds the next snapshot by structural
+ * sharing with the current one and swaps it in with a single atomic
+ * store. The new version is built entirely on the writer's thread,
+ * readers never wait for it.
+ *
+ * The modifying calls and publish() must all be made from the same
+ * thread (or be externally serialized), snapshot() can be called
+ * from anywhere. They throw std::out_of_range for a negative vertex
+ * label, and removing a vertex that is not in the graph, or an edge
+ * to or from one, stages nothing.
+ */
+class versioned_graph
+{
+  public:
+    versioned_graph(bool directed = true);
+
+    versioned_graph(const directed_weighted_graph &g);
+
+    versioned_graph(const undirected_weighted_graph &g);
+
+    ~versioned_graph() = default;
+
+    std::shared_ptr<const graph_snapshot> snapshot() const;
+
+    void addVertex(int vertex);
+
+    void removeVertex(int vertex);
+
+    void addEdge(int source, int dest, int weight);
+
+    void removeEdge(int source, int dest);
+
+    // number of vertices modified since the last publish
+    std::size_t pending() const;
+
+    std::shared_ptr<const graph_snapshot> publish();
+
+  private:
+    struct staged_vertex
+    {
+        bool present;
+        graph_snapshot::edge_list edges;
+    };
+
+    bool m_directed;
+    // only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const graph_snapshot> m_current;
+    std::map<int, staged_vertex> m_staged;
+
+    versioned_graph(const std::map<int, std::set<std::pair<int, int>>> &adjList, bool directed);
+
+    // writable copy of the vertex for the current batch
+    staged_vertex &stage(int vertex);
+
+    // whether `vertex` is in the graph, counting the staged changes
+    bool hasVertex(int vertex) const;
+
+    void insertEntry(int source, int dest, int weight);
+    void eraseEntries(int source, int dest);
+};
+
+inline int graph_snapshot::countVertices() const
+{
+    return m_vertices;
+}
+
+inline std::size_t graph_snapshot::countEdges() const
+{
+    return m_directed ? m_entries : m_entries / 2;
+}
+
+inline std::uint64_t graph_snapshot::version() const
+{
+    return m_version;
+}
+
+inline const std::shared_ptr<const graph_snapshot::edge_list> &graph_snapshot::list(int vertex) const
+{
+    static const std::shared_ptr<const edge_list> none;
+    if (vertex < 0 || vertex >= m_vertices || !m_chunks[vertex >> chunkBits])
+    {
+        return none;
+    }
+    return (*m_chunks[vertex >> chunkBits])[vertex & (chunkSize - 1)];
+}
+
+inline bool graph_snapshot::hasVertex(int vertex) const
+{
+    return static_cast<bool>(list(vertex));
+}
+
+inline const graph_snapshot::edge_list &graph_snapshot::edges(int vertex) const
+{
+    static const edge_list empty;
+    const auto &l = list(vertex);
+    return l ? *l : empty;
+}
+
+template <class Function>
+void graph_snapshot::forEachNeighbour(int vertex, Function f) const
+{
+    for (const auto &e : edges(vertex))
+    {
+        f(e.first, e.second);
+    }
+    return;
+}
+
+#endif /* ifndef VERSIONED_GRAPH_H */
@@ -0,0 +1,71 @@
+#include "../include/arena.h"
+#include <algorithm>
+
+const std::size_t arena::granularity;
+const std::size_t arena::maxPooledSize;
+
+arena::arena(std::size_t blockBytes)
+    : m_freeLists(maxPooledSize / granularity, nullptr), m_cursor(nullptr),
+      m_end(nullptr), m_blockBytes(std::max(blockBytes, maxPooledSize)),
+      m_reserved(0), m_inUse(0)
+{
+}
+
+arena::~arena()
+{
+    for (auto block : m_blocks)
+    {
+        ::operator delete(block);
+    }
+}
+
+void *arena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (!pooled(bytes, alignment))
+    {
+        return ::operator new(bytes);
+    }
+
+    // round up to the size class, reuse a freed node if there is one
+    std::size_t index = bytes == 0 ? 0 : (bytes - 1) / granularity;
+    std::size_t size = (index + 1) * granularity;
+    m_inUse += size;
+
+    free_node *node = m_freeLists[index];
+    if (node)
+    {
+        m_freeLists[index] = node->next;
+        return node;
+    }
+
+    // otherwise bump allocate, starting a new block if needed. The
+    // blocks come from operator new and every size class is a
+    // multiple of the granularity, so the cursor stays aligned.
+    if (static_cast<std::size_t>(m_end - m_cursor) < size)
+    {
+        m_blocks.push_back(::operator new(m_blockBytes));
+        m_cursor = static_cast<char *>(m_blocks.back());
+        m_end = m_cursor + m_blockBytes;
+        m_reserved += m_blockBytes;
+    }
+    void *p = m_cursor;
+    m_cursor += size;
+    return p;
+}
+
+void arena::deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+{
+    if (!pooled(bytes, alignment))
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    std::size_t index = bytes == 0 ? 0 : (bytes - 1) / granularity;
+    m_inUse -= (index + 1) * granularity;
+
+    free_node *node = static_cast<free_node *>(p);
+    node->next = m_freeLists[index];
+    m_freeLists[index] = node;
+    return;
+}
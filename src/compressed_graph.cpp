@@ -0,0 +1,354 @@
+#include "../include/compressed_graph.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+static const char fileMagic[8] = {'D', 'W', 'G', 'Z', 'I', 'P', '0', '1'};
+
+static void writeVarint(std::vector<unsigned char> &out, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(value);
+    return;
+}
+
+static void writeFixed(unsigned char *out, std::uint32_t value)
+{
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+    return;
+}
+
+static std::uint32_t zigzag(int value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+compressed_graph::compressed_graph() : m_offsets(1, 0), m_edges(0), m_maxTarget(-1)
+{
+}
+
+compressed_graph::compressed_graph(const graph &g) : compressed_graph(csr_graph(g))
+{
+}
+
+compressed_graph::compressed_graph(const csr_graph &g) : compressed_graph()
+{
+    m_offsets.reserve(g.countVertices() + 1);
+    std::vector<std::pair<int, int>> row;
+    for (int v = 0; v < g.countVertices(); ++v)
+    {
+        row.clear();
+        for (int i = 0; i < g.degree(v); ++i)
+        {
+            row.emplace_back(g.targets(v)[i], g.weights(v)[i]);
+        }
+        appendRow(row);
+    }
+    m_data.shrink_to_fit();
+}
+
+void compressed_graph::appendRow(std::vector<std::pair<int, int>> &row)
+{
+    int vertex = countVertices();
+    std::sort(row.begin(), row.end());
+    if (!row.empty() && row.front().first < 0)
+    {
+        throw std::out_of_range("compressed_graph: negative target");
+    }
+
+    std::uint32_t degree = row.size();
+    writeVarint(m_data, degree);
+    if (degree > 0)
+    {
+        // reserve the skip table, it is filled in as the blocks are
+        // written.
+        std::uint32_t blocks = (degree + blockSize - 1) / blockSize;
+        std::size_t skip = m_data.size();
+        m_data.resize(skip + 8 * (blocks - 1));
+        std::size_t blocksBegin = m_data.size();
+
+        int previous = vertex;
+        for (std::uint32_t i = 0; i < degree; ++i)
+        {
+            int target = row[i].first;
+            if (i == 0)
+            {
+                writeVarint(m_data, zigzag(target - vertex));
+            }
+            else if (i % blockSize == 0)
+            {
+                unsigned char *entry = &m_data[skip + 8 * (i / blockSize - 1)];
+                writeFixed(entry, target);
+                writeFixed(entry + 4, m_data.size() - blocksBegin);
+            }
+            else
+            {
+                writeVarint(m_data, target - previous);
+            }
+            writeVarint(m_data, zigzag(row[i].second));
+            previous = target;
+        }
+    }
+
+    if (degree > 0)
+    {
+        m_maxTarget = std::max(m_maxTarget, row.back().first);
+    }
+    m_edges += degree;
+    m_offsets.push_back(m_data.size());
+    return;
+}
+
+int compressed_graph::degree(int vertex) const
+{
+    std::uint32_t degree;
+    rowBegin(vertex, degree);
+    return degree;
+}
+
+bool compressed_graph::findEdge(int source, int dest, int &weight) const
+{
+    std::uint32_t degree;
+    const unsigned char *p = rowBegin(source, degree);
+    if (degree == 0)
+    {
+        return false;
+    }
+
+    // binary search the skip table for the last block whose first
+    // target is smaller than `dest`; parallel edges to `dest` can
+    // start at the end of that block.
+    std::uint32_t blocks = (degree + blockSize - 1) / blockSize;
+    const unsigned char *skip = p;
+    const unsigned char *data = p + 8 * (blocks - 1);
+
+    std::uint32_t lo = 0, hi = blocks - 1;
+    while (lo < hi)
+    {
+        std::uint32_t mid = (lo + hi + 1) / 2;
+        if (static_cast<int>(readFixed(skip + 8 * (mid - 1))) < dest)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    // decode from the selected block on, the edges to `dest` may
+    // spill over into the following blocks.
+    int target;
+    std::uint32_t i = lo * blockSize;
+    if (lo == 0)
+    {
+        target = source + unzigzag(readVarint(data));
+    }
+    else
+    {
+        target = readFixed(skip + 8 * (lo - 1));
+        data += readFixed(skip + 8 * (lo - 1) + 4);
+    }
+
+    bool found = false;
+    weight = std::numeric_limits<int>::max();
+    while (true)
+    {
+        int w = unzigzag(readVarint(data));
+        if (target == dest)
+        {
+            found = true;
+            weight = std::min(weight, w);
+        }
+        if (target > dest || ++i == degree)
+        {
+            break;
+        }
+        if (i % blockSize == 0)
+        {
+            target = readFixed(skip + 8 * (i / blockSize - 1));
+        }
+        else
+        {
+            target += readVarint(data);
+        }
+    }
+    return found;
+}
+
+std::size_t compressed_graph::memoryUsage() const
+{
+    return m_data.size() * sizeof(unsigned char) + m_offsets.size() * sizeof(std::uint64_t);
+}
+
+bool compressed_graph::write(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::uint64_t header[3] = {m_offsets.size(), m_data.size(), m_edges};
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(m_offsets.data()),
+               m_offsets.size() * sizeof(std::uint64_t));
+    file.write(reinterpret_cast<const char *>(m_data.data()), m_data.size());
+    return file.good();
+}
+
+bool compressed_graph::readVarint(const unsigned char *&p, const unsigned char *end,
+                                  std::uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && p != end; shift += 7)
+    {
+        std::uint32_t byte = *p++;
+        if (shift == 28 && (byte & 0x70) != 0)
+        {
+            return false;
+        }
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool compressed_graph::validRow(int vertex, std::size_t &edges, int &maxTarget) const
+{
+    const unsigned char *p = m_data.data() + m_offsets[vertex];
+    const unsigned char *end = m_data.data() + m_offsets[vertex + 1];
+    std::uint32_t degree, value;
+    if (!readVarint(p, end, degree))
+    {
+        return false;
+    }
+    if (degree == 0)
+    {
+        return p == end;
+    }
+
+    // the skip table must fit in the row, and every entry must point
+    // at the place where the block actually starts, as findEdge jumps
+    // there directly.
+    std::uint64_t blocks = (static_cast<std::uint64_t>(degree) + blockSize - 1) / blockSize;
+    if (8 * (blocks - 1) > static_cast<std::uint64_t>(end - p))
+    {
+        return false;
+    }
+    const unsigned char *skip = p;
+    p += 8 * (blocks - 1);
+    const unsigned char *blocksBegin = p;
+
+    long long target = vertex;
+    for (std::uint32_t i = 0; i < degree; ++i)
+    {
+        if (i == 0)
+        {
+            if (!readVarint(p, end, value))
+            {
+                return false;
+            }
+            target += unzigzag(value);
+        }
+        else if (i % blockSize == 0)
+        {
+            const unsigned char *entry = skip + 8 * (i / blockSize - 1);
+            if (readFixed(entry + 4) != static_cast<std::uint32_t>(p - blocksBegin) ||
+                readFixed(entry) < target)
+            {
+                return false;
+            }
+            target = readFixed(entry);
+        }
+        else
+        {
+            if (!readVarint(p, end, value))
+            {
+                return false;
+            }
+            target += value;
+        }
+        if (target < 0 || target >= countVertices() || !readVarint(p, end, value))
+        {
+            return false;
+        }
+        maxTarget = std::max<int>(maxTarget, target);
+    }
+
+    edges += degree;
+    return p == end;
+}
+
+bool compressed_graph::read(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // the counts of the header are checked against the size of the
+    // file before anything gets allocated.
+    std::uint64_t size = file.tellg();
+    char magic[sizeof(fileMagic)];
+    std::uint64_t header[3];
+    file.seekg(0);
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!file || !std::equal(magic, magic + sizeof(magic), fileMagic))
+    {
+        return false;
+    }
+
+    std::uint64_t payload = size - sizeof(magic) - sizeof(header);
+    std::uint64_t maxVertices = std::numeric_limits<int>::max();
+    if (header[0] == 0 || header[0] - 1 > maxVertices ||
+        header[0] > payload / sizeof(std::uint64_t) ||
+        header[1] != payload - header[0] * sizeof(std::uint64_t))
+    {
+        return false;
+    }
+
+    compressed_graph loaded;
+    loaded.m_offsets.resize(header[0]);
+    loaded.m_data.resize(header[1]);
+    file.read(reinterpret_cast<char *>(loaded.m_offsets.data()),
+              loaded.m_offsets.size() * sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char *>(loaded.m_data.data()), loaded.m_data.size());
+    if (!file || loaded.m_offsets.front() != 0 || loaded.m_offsets.back() != loaded.m_data.size() ||
+        !std::is_sorted(loaded.m_offsets.begin(), loaded.m_offsets.end()))
+    {
+        return false;
+    }
+
+    for (int v = 0; v < loaded.countVertices(); ++v)
+    {
+        if (!loaded.validRow(v, loaded.m_edges, loaded.m_maxTarget))
+        {
+            return false;
+        }
+    }
+    if (loaded.m_edges != header[2])
+    {
+        return false;
+    }
+
+    m_offsets.swap(loaded.m_offsets);
+    m_data.swap(loaded.m_data);
+    m_edges = loaded.m_edges;
+    m_maxTarget = loaded.m_maxTarget;
+    return true;
+}
@@ -0,0 +1,137 @@
+#include "../include/csr_graph.h"
+#include "../include/graph_reorder.h"
+
+csr_graph::csr_graph(const graph &g) : csr_graph(g.getAdjacencyList())
+{
+}
+
+csr_graph::csr_graph(const std::map<int, std::set<std::pair<int, int>>> &adjList)
+{
+    if (adjList.empty())
+    {
+        return;
+    }
+    if (adjList.begin()->first < 0)
+    {
+        throw std::out_of_range("csr_graph: negative vertex label");
+    }
+
+    // the map is ordered, so the last key is the largest vertex
+    // label. Targets are normally vertices of the map as well, but
+    // make room for any stray target label just in case.
+    int vertices = adjList.rbegin()->first + 1;
+    for (const auto &it : adjList)
+    {
+        if (!it.second.empty())
+        {
+            vertices = std::max(vertices, it.second.rbegin()->first + 1);
+        }
+    }
+
+    // first pass: count the out-degree of every vertex slot and turn
+    // the counts into offsets with a prefix sum.
+    m_offsets.assign(vertices + 1, 0);
+    for (const auto &it : adjList)
+    {
+        m_offsets[it.first + 1] = it.second.size();
+    }
+    for (int v = 0; v < vertices; ++v)
+    {
+        m_offsets[v + 1] += m_offsets[v];
+    }
+
+    // second pass: copy the edges. The sets are already sorted by
+    // target, so every row of the CSR arrays is sorted as well.
+    m_targets.resize(m_offsets[vertices]);
+    m_weights.resize(m_offsets[vertices]);
+    for (const auto &it : adjList)
+    {
+        std::size_t pos = m_offsets[it.first];
+        for (const auto &e : it.second)
+        {
+            m_targets[pos] = e.first;
+            m_weights[pos] = e.second;
+            ++pos;
+        }
+    }
+    return;
+}
+
+csr_graph::csr_graph(const csr_graph &g, const vertex_ordering &order)
+{
+    int vertices = g.countVertices();
+    if (order.size() != vertices)
+    {
+        throw std::invalid_argument("csr_graph: ordering does not match the graph");
+    }
+
+    // the degree of the i-th new vertex is the degree of the old
+    // vertex placed at position i.
+    m_offsets.assign(vertices + 1, 0);
+    for (int v = 0; v < vertices; ++v)
+    {
+        m_offsets[v + 1] = m_offsets[v] + g.degree(order.toExternal(v));
+    }
+
+    // copy the renamed rows and sort them again by target, so that
+    // rows stay ordered like the ones built from the adjacency list.
+    m_targets.resize(g.countEdges());
+    m_weights.resize(g.countEdges());
+    std::vector<std::pair<int, int>> row;
+    for (int v = 0; v < vertices; ++v)
+    {
+        int old = order.toExternal(v);
+        row.clear();
+        for (int i = 0; i < g.degree(old); ++i)
+        {
+            row.emplace_back(order.toInternal(g.targets(old)[i]), g.weights(old)[i]);
+        }
+        std::sort(row.begin(), row.end());
+
+        std::size_t pos = m_offsets[v];
+        for (const auto &e : row)
+        {
+            m_targets[pos] = e.first;
+            m_weights[pos] = e.second;
+            ++pos;
+        }
+    }
+    return;
+}
+
+csr_graph csr_graph::reversed() const
+{
+    csr_graph r;
+    int vertices = countVertices();
+    if (vertices == 0)
+    {
+        return r;
+    }
+
+    // count the in-degrees, then scatter the edges. Sources are
+    // visited in increasing order, so the rows come out sorted.
+    r.m_offsets.assign(vertices + 1, 0);
+    for (int target : m_targets)
+    {
+        ++r.m_offsets[target + 1];
+    }
+    for (int v = 0; v < vertices; ++v)
+    {
+        r.m_offsets[v + 1] += r.m_offsets[v];
+    }
+
+    std::vector<std::size_t> pos(r.m_offsets.begin(), r.m_offsets.end() - 1);
+    r.m_targets.resize(m_targets.size());
+    r.m_weights.resize(m_weights.size());
+    for (int u = 0; u < vertices; ++u)
+    {
+        for (std::size_t i = m_offsets[u]; i < m_offsets[u + 1]; ++i)
+        {
+            std::size_t &p = pos[m_targets[i]];
+            r.m_targets[p] = u;
+            r.m_weights[p] = m_weights[i];
+            ++p;
+        }
+    }
+    return r;
+}
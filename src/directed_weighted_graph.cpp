@@ -1,10 +1,22 @@
 #include "../include/directed_weighted_graph.h"
+#include "../include/edge_batch.h"
 
 directed_weighted_graph::directed_weighted_graph(int vertices)
+    : directed_weighted_graph(vertices, nullptr)
+{
+}
+
+directed_weighted_graph::directed_weighted_graph(std::shared_ptr<arena> pool)
+    : m_adjList(arena_allocator<adjacency_map::value_type>(pool))
+{
+}
+
+directed_weighted_graph::directed_weighted_graph(int vertices, std::shared_ptr<arena> pool)
+    : directed_weighted_graph(pool)
 {
     for (int i = 0; i < vertices; ++i)
     {
-        m_adjList[i] = std::set<std::pair<int, int>>();
+        m_adjList.emplace_hint(m_adjList.end(), i, adjacency_set(m_adjList.get_allocator()));
     }
 }
 
@@ -14,14 +26,16 @@ void directed_weighted_graph::addVertex(int vertex)
     // add it to the list.
     if (m_adjList.empty())
     {
-        m_adjList.emplace(vertex, std::set<std::pair<int, int>>());
+        m_adjList.emplace(vertex, adjacency_set(m_adjList.get_allocator()));
+        bumpVersion();
         return;
     }
     // check to see if the vertex is already in the adjacency list.
     // If not, add it to the list.
     if (m_adjList.find(vertex) == m_adjList.end())
     {
-        m_adjList.emplace(vertex, std::set<std::pair<int, int>>());
+        m_adjList.emplace(vertex, adjacency_set(m_adjList.get_allocator()));
+        bumpVersion();
     }
     return;
 }
@@ -29,19 +43,20 @@ void directed_weighted_graph::addVertex(int vertex)
 void directed_weighted_graph::removeVertex(int vertex)
 {
     // first delete the vertex
-    m_adjList.erase(vertex);
+    auto it = m_adjList.find(vertex);
+    if (it != m_adjList.end())
+    {
+        m_entries -= it->second.size();
+        m_adjList.erase(it);
+    }
 
-    // remove all entries connected to the removed vertex
-    for (auto i : m_adjList)
+    // remove all entries connected to the removed vertex, the
+    // entries to a vertex are a contiguous range of every set.
+    for (auto &i : m_adjList)
     {
-        for (auto j : i.second)
-        {
-            if (j.first == vertex)
-            {
-                i.second.erase(j);
-            }
-        }
+        m_entries -= eraseEntries(i.second, vertex);
     }
+    bumpVersion();
     return;
 }
 
@@ -54,23 +69,31 @@ void directed_weighted_graph::addEdge(int source, int dest, int weight)
 
     // create connections between the source and destination
     // vertices
-    m_adjList[source].emplace(dest, weight);
+    m_entries += m_adjList.find(source)->second.emplace(dest, weight).second;
+    bumpVersion();
+    return;
+}
+
+void directed_weighted_graph::addEdges(const std::vector<weighted_edge> &edges)
+{
+    // sort and deduplicate a private copy of the batch, then
+    // append it to the adjacency list in a single ordered pass.
+    std::vector<weighted_edge> batch(edges);
+    sortEdges(batch);
+    m_entries += insertSortedEdges(m_adjList, batch);
+    bumpVersion();
     return;
 }
 
 void directed_weighted_graph::removeEdge(int source, int dest)
 {
     // remove the connections between source and destination
-    if (m_adjList.find(source) != m_adjList.end())
+    auto it = m_adjList.find(source);
+    if (it != m_adjList.end())
     {
-        for (auto d : m_adjList[source])
-        {
-            if (d.first == dest)
-            {
-                m_adjList[source].erase(d);
-            }
-        }
+        m_entries -= eraseEntries(it->second, dest);
     }
+    bumpVersion();
     return;
 }
 
@@ -79,15 +102,14 @@ int directed_weighted_graph::countVertices()
     return m_adjList.size();
 }
 
-int directed_weighted_graph::countEdges()
+std::size_t directed_weighted_graph::countEdges()
 {
-    // iterate through the map and sum up the set sizes.
-    int edges = 0;
-    for (auto i : m_adjList)
-    {
-        edges += i.second.size();
-    }
-    return edges;
+    return m_entries;
+}
+
+graph_memory directed_weighted_graph::memoryUsage() const
+{
+    return adjacencyMemory(m_adjList, m_entries, sizeof(*this));
 }
 
 bool directed_weighted_graph::writeDot(std::string filename)
@@ -139,7 +161,14 @@ std::vector<int> directed_weighted_graph::getVertices() const
 
 std::map<int, std::set<std::pair<int, int>>> directed_weighted_graph::getAdjacencyList() const
 {
-    return m_adjList;
+    // copy into the standard containers of the graph interface
+    std::map<int, std::set<std::pair<int, int>>> adjList;
+    for (const auto &it : m_adjList)
+    {
+        adjList.emplace_hint(adjList.end(), it.first,
+                             std::set<std::pair<int, int>>(it.second.begin(), it.second.end()));
+    }
+    return adjList;
 }
 
 std::ostream &operator<<(std::ostream &oss, const directed_weighted_graph &graph)
@@ -0,0 +1,72 @@
+#include "../include/edge_batch.h"
+#include "../include/parallel_sort.h"
+#include <algorithm>
+
+static bool edgeLess(const weighted_edge &a, const weighted_edge &b)
+{
+    if (a.source != b.source)
+    {
+        return a.source < b.source;
+    }
+    if (a.dest != b.dest)
+    {
+        return a.dest < b.dest;
+    }
+    return a.weight < b.weight;
+}
+
+static bool edgeEqual(const weighted_edge &a, const weighted_edge &b)
+{
+    return a.source == b.source && a.dest == b.dest && a.weight == b.weight;
+}
+
+void sortEdges(std::vector<weighted_edge> &edges)
+{
+    parallel_sort(edges, edgeLess);
+    edges.erase(std::unique(edges.begin(), edges.end(), edgeEqual), edges.end());
+    return;
+}
+
+std::size_t insertSortedEdges(adjacency_map &adjList, const std::vector<weighted_edge> &edges)
+{
+    // every vertex touched by the batch, sorted so that each one can
+    // be inserted right after the previous one.
+    std::vector<int> vertices;
+    vertices.reserve(2 * edges.size());
+    for (const auto &e : edges)
+    {
+        if (vertices.empty() || vertices.back() != e.source)
+        {
+            vertices.push_back(e.source);
+        }
+        vertices.push_back(e.dest);
+    }
+    parallel_sort(vertices);
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    auto hint = adjList.begin();
+    for (int v : vertices)
+    {
+        hint = adjList.emplace_hint(hint, v, adjacency_set(adjList.get_allocator()));
+        ++hint;
+    }
+
+    // the edges are grouped by source and sorted by destination, so
+    // every entry is appended at the position of the previous one.
+    std::size_t inserted = 0;
+    auto source = adjList.end();
+    adjacency_set::iterator pos;
+    for (const auto &e : edges)
+    {
+        if (source == adjList.end() || source->first != e.source)
+        {
+            source = adjList.find(e.source);
+            pos = source->second.begin();
+        }
+        std::size_t before = source->second.size();
+        pos = source->second.emplace_hint(pos, e.dest, e.weight);
+        inserted += source->second.size() - before;
+        ++pos;
+    }
+    return inserted;
+}
@@ -0,0 +1,257 @@
+#include "../include/external_graph.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
+
+static const char fileMagic[8] = {'D', 'W', 'G', 'E', 'X', 'T', '0', '1'};
+static const std::uint64_t headerBytes = 64;
+
+const int external_graph::chunkEdges;
+
+external_graph::external_graph(std::size_t cacheBytes, std::size_t blockBytes)
+    : m_fd(-1), m_fileBytes(0), m_vertices(0), m_edges(0), m_edgesBegin(0),
+      m_stats{0, 0, 0, 0, 0}
+{
+    // whole pages, so that the reads and the readahead line up with
+    // the page cache; two blocks at least, for the offsets and the
+    // edges of a row.
+    const std::size_t page = 4096;
+    m_blockBytes = std::max(page, (blockBytes + page - 1) / page * page);
+    m_capacity = std::max<std::size_t>(2, cacheBytes / m_blockBytes);
+}
+
+external_graph::~external_graph()
+{
+    close();
+}
+
+void external_graph::close()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_lru.clear();
+    m_blocks.clear();
+    m_advised.clear();
+    return;
+}
+
+/*
+ * Writes the header, the offsets and the edges; `row(v, out)` fills
+ * `out` with the <target, weight> pairs of vertex v.
+ */
+template <class Row>
+static bool writeRows(const std::string &filename, int vertices, std::uint64_t edges, Row row)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    unsigned char header[headerBytes] = {0};
+    std::uint64_t counts[2] = {static_cast<std::uint64_t>(vertices), edges};
+    std::memcpy(header, fileMagic, sizeof(fileMagic));
+    std::memcpy(header + sizeof(fileMagic), counts, sizeof(counts));
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    // the offsets first, then the rows in a second pass
+    std::vector<std::int32_t> out;
+    std::uint64_t offset = 0;
+    file.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    for (int v = 0; v < vertices; ++v)
+    {
+        out.clear();
+        row(v, out);
+        offset += out.size() / 2;
+        file.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    }
+    for (int v = 0; v < vertices; ++v)
+    {
+        out.clear();
+        row(v, out);
+        file.write(reinterpret_cast<const char *>(out.data()), out.size() * sizeof(std::int32_t));
+    }
+    return file.good() && offset == edges;
+}
+
+bool external_graph::write(const std::string &filename, const csr_graph &g)
+{
+    return writeRows(filename, g.countVertices(), g.countEdges(),
+                     [&g](int v, std::vector<std::int32_t> &out) {
+                         for (int i = 0; i < g.degree(v); ++i)
+                         {
+                             out.push_back(g.targets(v)[i]);
+                             out.push_back(g.weights(v)[i]);
+                         }
+                     });
+}
+
+bool external_graph::write(const std::string &filename, const compressed_graph &g)
+{
+    return writeRows(filename, g.countVertices(), g.countEdges(),
+                     [&g](int v, std::vector<std::int32_t> &out) {
+                         g.forEachNeighbour(v, [&out](int target, int weight) {
+                             out.push_back(target);
+                             out.push_back(weight);
+                         });
+                     });
+}
+
+bool external_graph::open(const std::string &filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    unsigned char header[headerBytes];
+    std::uint64_t counts[2];
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size < static_cast<off_t>(headerBytes) ||
+        ::pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        !std::equal(fileMagic, fileMagic + sizeof(fileMagic), header))
+    {
+        ::close(fd);
+        return false;
+    }
+    std::memcpy(counts, header + sizeof(fileMagic), sizeof(counts));
+
+    std::uint64_t edgesBegin = headerBytes + 8 * (counts[0] + 1);
+    if (counts[0] > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+        static_cast<std::uint64_t>(size) != edgesBegin + 8 * counts[1])
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // the access pattern of a search is random
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+    m_fd = fd;
+    m_fileBytes = size;
+    m_vertices = counts[0];
+    m_edges = counts[1];
+    m_edgesBegin = edgesBegin;
+    return true;
+}
+
+const unsigned char *external_graph::block(std::uint64_t index)
+{
+    auto it = m_blocks.find(index);
+    if (it != m_blocks.end())
+    {
+        ++m_stats.hits;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->data.data();
+    }
+    ++m_stats.misses;
+
+    // recycle the buffer of the least recently used block once the
+    // cache is full
+    if (m_blocks.size() < m_capacity)
+    {
+        m_lru.push_front(cached_block{index, std::vector<unsigned char>(m_blockBytes)});
+    }
+    else
+    {
+        ++m_stats.evictions;
+        m_blocks.erase(m_lru.back().index);
+        m_lru.splice(m_lru.begin(), m_lru, std::prev(m_lru.end()));
+        m_lru.front().index = index;
+    }
+
+    std::uint64_t position = index * m_blockBytes;
+    std::size_t bytes = std::min<std::uint64_t>(m_blockBytes, m_fileBytes - position);
+    std::size_t done = 0;
+    while (done < bytes)
+    {
+        ssize_t n = ::pread(m_fd, m_lru.front().data.data() + done, bytes - done, position + done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            m_lru.pop_front();
+            throw std::runtime_error("external_graph: reading the adjacency file failed");
+        }
+        done += n;
+    }
+
+    m_stats.bytesRead += bytes;
+    m_advised.erase(index);
+    m_blocks.emplace(index, m_lru.begin());
+    return m_lru.front().data.data();
+}
+
+void external_graph::advise(std::uint64_t index)
+{
+    if (m_blocks.count(index) || !m_advised.insert(index).second)
+    {
+        return;
+    }
+    // forget old requests rather than let the set grow, a repeated
+    // request is harmless.
+    if (m_advised.size() > m_capacity)
+    {
+        m_advised.clear();
+        m_advised.insert(index);
+    }
+    ++m_stats.prefetches;
+    ::posix_fadvise(m_fd, index * m_blockBytes, m_blockBytes, POSIX_FADV_WILLNEED);
+    return;
+}
+
+void external_graph::prefetch(int vertex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // the row can only be located once its offsets are in memory,
+    // until then read ahead the offsets themselves.
+    std::uint64_t position = headerBytes + 8 * static_cast<std::uint64_t>(vertex);
+    std::uint64_t first = position / m_blockBytes;
+    std::uint64_t last = (position + 8) / m_blockBytes;
+    if (!m_blocks.count(first) || !m_blocks.count(last))
+    {
+        advise(first);
+        advise(last);
+        return;
+    }
+
+    // peek at the cached offsets, without counting a cache access
+    auto offset = [this](std::uint64_t at) {
+        std::uint64_t value;
+        const auto &data = m_blocks.find(at / m_blockBytes)->second->data;
+        std::memcpy(&value, data.data() + at % m_blockBytes, sizeof(value));
+        return value;
+    };
+    std::uint64_t from = offset(position), to = offset(position + 8);
+    if (!validRange(from, to))
+    {
+        // forEachNeighbour reports it
+        return;
+    }
+    std::uint64_t begin = m_edgesBegin + 8 * from;
+    std::uint64_t end = m_edgesBegin + 8 * to;
+    for (std::uint64_t b = begin / m_blockBytes; begin < end && b <= (end - 1) / m_blockBytes; ++b)
+    {
+        advise(b);
+    }
+    return;
+}
+
+void external_graph::resetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = io_stats{0, 0, 0, 0, 0};
+    return;
+}
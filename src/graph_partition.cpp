@@ -0,0 +1,141 @@
+#include "../include/graph_partition.h"
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * Breadth first traversal of the part `part` (the vertices whose mark
+ * equals `mark`) from `root`, ignoring edge directions. Components of
+ * the part that are not reachable from `root` are appended after it.
+ * Returns the vertices in the order they were visited.
+ */
+static std::vector<int> partBfs(const csr_graph &g, const csr_graph &reverse,
+                                const std::vector<int> &part, int root,
+                                std::vector<int> &mark, int current, int visited)
+{
+    std::vector<int> order;
+    order.reserve(part.size());
+
+    auto visit = [&](int v) {
+        if (mark[v] == current)
+        {
+            mark[v] = visited;
+            order.push_back(v);
+        }
+    };
+
+    std::size_t next = 0;
+    visit(root);
+    for (int start : part)
+    {
+        visit(start);
+        while (next < order.size())
+        {
+            int u = order[next++];
+            for (int i = 0; i < g.degree(u); ++i)
+            {
+                visit(g.targets(u)[i]);
+            }
+            for (int i = 0; i < reverse.degree(u); ++i)
+            {
+                visit(reverse.targets(u)[i]);
+            }
+        }
+    }
+
+    // restore the marks of the part for the next traversal
+    for (int v : order)
+    {
+        mark[v] = current;
+    }
+    return order;
+}
+
+std::vector<int> partitionGraph(const csr_graph &g, int maxCellSize)
+{
+    return partitionGraph(g, std::vector<int>(1, maxCellSize))[0];
+}
+
+std::vector<std::vector<int>> partitionGraph(const csr_graph &g, const std::vector<int> &cellSizes)
+{
+    for (std::size_t l = 0; l < cellSizes.size(); ++l)
+    {
+        if (cellSizes[l] <= 0 || (l > 0 && cellSizes[l] <= cellSizes[l - 1]))
+        {
+            throw std::invalid_argument("partitionGraph: cell sizes must be positive and increasing");
+        }
+    }
+
+    int n = g.countVertices();
+    csr_graph reverse = g.reversed();
+    int levels = cellSizes.size();
+    std::vector<std::vector<int>> cells(levels, std::vector<int>(n, -1));
+    std::vector<int> counts(levels, 0);
+
+    // mark[v] is the id of the part v currently belongs to. Parts are
+    // processed depth first, and carry the number of (finest) levels
+    // whose cells have not been assigned yet.
+    struct part_entry
+    {
+        int id;
+        int pending;
+        std::vector<int> vertices;
+    };
+    std::vector<int> mark(n, 0);
+    std::vector<part_entry> stack;
+    int parts = 1;
+
+    std::vector<int> all(n);
+    for (int v = 0; v < n; ++v)
+    {
+        all[v] = v;
+    }
+    stack.push_back(part_entry{0, levels, std::move(all)});
+
+    while (!stack.empty())
+    {
+        int id = stack.back().id;
+        int pending = stack.back().pending;
+        std::vector<int> part = std::move(stack.back().vertices);
+        stack.pop_back();
+
+        // the part is a cell of every level it fits in
+        while (pending > 0 && static_cast<int>(part.size()) <= cellSizes[pending - 1])
+        {
+            --pending;
+            for (int v : part)
+            {
+                cells[pending][v] = counts[pending];
+            }
+            ++counts[pending];
+        }
+        if (pending == 0)
+        {
+            continue;
+        }
+
+        // two sweeps find a vertex far away from the rest of the
+        // part, growing the region from there keeps the cut short.
+        int visited = parts++;
+        int root = partBfs(g, reverse, part, part[0], mark, id, visited).back();
+        std::vector<int> order = partBfs(g, reverse, part, root, mark, id, visited);
+        root = order.back();
+        order = partBfs(g, reverse, part, root, mark, id, visited);
+
+        int a = parts++;
+        int b = parts++;
+        std::size_t half = order.size() / 2;
+        std::vector<int> first(order.begin(), order.begin() + half);
+        std::vector<int> second(order.begin() + half, order.end());
+        for (int v : first)
+        {
+            mark[v] = a;
+        }
+        for (int v : second)
+        {
+            mark[v] = b;
+        }
+        stack.push_back(part_entry{b, pending, std::move(second)});
+        stack.push_back(part_entry{a, pending, std::move(first)});
+    }
+    return cells;
+}
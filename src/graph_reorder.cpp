@@ -0,0 +1,248 @@
+#include "../include/graph_reorder.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+vertex_ordering::vertex_ordering(const std::vector<int> &order)
+    : m_toInternal(order.size(), -1), m_toExternal(order)
+{
+    int n = order.size();
+    for (int i = 0; i < n; ++i)
+    {
+        int v = order[i];
+        if (v < 0 || v >= n || m_toInternal[v] != -1)
+        {
+            throw std::invalid_argument("vertex_ordering: not a permutation");
+        }
+        m_toInternal[v] = i;
+    }
+}
+
+/*
+ * Breadth first traversal from `root` appending the visited vertices
+ * to `order`. Returns the index of the first vertex of the last BFS
+ * level, and the number of levels in `depth` if requested. If
+ * `byDegree` is set, the neighbours of every vertex are visited by
+ * increasing degree (the Cuthill-McKee rule).
+ */
+static std::size_t bfs(const csr_graph &g, int root, bool byDegree,
+                       std::vector<bool> &visited, std::vector<int> &order,
+                       int *depth = nullptr)
+{
+    std::vector<int> neighbours;
+    std::size_t head = order.size();
+    std::size_t levelEnd = head + 1;
+    std::size_t lastLevel = head;
+    int levels = 1;
+
+    visited[root] = true;
+    order.push_back(root);
+    while (head < order.size())
+    {
+        if (head == levelEnd)
+        {
+            lastLevel = head;
+            levelEnd = order.size();
+            ++levels;
+        }
+        int u = order[head++];
+
+        neighbours.clear();
+        const int *targets = g.targets(u);
+        for (int i = 0; i < g.degree(u); ++i)
+        {
+            if (!visited[targets[i]])
+            {
+                visited[targets[i]] = true;
+                neighbours.push_back(targets[i]);
+            }
+        }
+        if (byDegree)
+        {
+            std::stable_sort(neighbours.begin(), neighbours.end(),
+                             [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+        }
+        order.insert(order.end(), neighbours.begin(), neighbours.end());
+    }
+
+    if (depth)
+    {
+        *depth = levels;
+    }
+    return lastLevel;
+}
+
+vertex_ordering bfsOrder(const csr_graph &g, int root)
+{
+    int n = g.countVertices();
+    if (n == 0)
+    {
+        return vertex_ordering();
+    }
+    if (root < 0 || root >= n)
+    {
+        throw std::out_of_range("bfsOrder: root vertex not in graph");
+    }
+
+    std::vector<bool> visited(n, false);
+    std::vector<int> order;
+    order.reserve(n);
+
+    bfs(g, root, false, visited, order);
+    for (int v = 0; v < n; ++v)
+    {
+        if (!visited[v])
+        {
+            bfs(g, v, false, visited, order);
+        }
+    }
+    return vertex_ordering(order);
+}
+
+/*
+ * George-Liu heuristic: repeatedly move the start vertex to a minimum
+ * degree vertex of the last BFS level, as long as that increases the
+ * depth of the BFS tree. `visited` marks the vertices of the
+ * components that were already ordered, and is left unchanged.
+ */
+static int pseudoPeripheral(const csr_graph &g, int start,
+                            std::vector<bool> &visited)
+{
+    std::vector<int> order;
+    int depth = 0;
+    while (true)
+    {
+        int levels = 0;
+        order.clear();
+        std::size_t lastLevel = bfs(g, start, false, visited, order, &levels);
+
+        // undo the marks of this trial traversal
+        for (int v : order)
+        {
+            visited[v] = false;
+        }
+        if (levels <= depth)
+        {
+            return start;
+        }
+        depth = levels;
+
+        int candidate = order[lastLevel];
+        for (std::size_t i = lastLevel; i < order.size(); ++i)
+        {
+            if (g.degree(order[i]) < g.degree(candidate))
+            {
+                candidate = order[i];
+            }
+        }
+        if (candidate == start)
+        {
+            return start;
+        }
+        start = candidate;
+    }
+}
+
+vertex_ordering reverseCuthillMcKee(const csr_graph &g)
+{
+    int n = g.countVertices();
+    if (n == 0)
+    {
+        return vertex_ordering();
+    }
+
+    // visit the components starting from their lowest degree vertex
+    std::vector<int> byDegree(n);
+    for (int v = 0; v < n; ++v)
+    {
+        byDegree[v] = v;
+    }
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+                     [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+
+    std::vector<bool> visited(n, false);
+    std::vector<int> order;
+    order.reserve(n);
+    for (int v : byDegree)
+    {
+        // on directed graphs the peripheral vertex may not reach v,
+        // which then starts a traversal of its own.
+        while (!visited[v])
+        {
+            bfs(g, pseudoPeripheral(g, v, visited), true, visited, order);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return vertex_ordering(order);
+}
+
+/*
+ * Position of the cell (x, y) along a Hilbert curve filling a
+ * 2^16 x 2^16 grid.
+ */
+static std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y)
+{
+    const std::uint32_t side = 1u << 16;
+    std::uint64_t d = 0;
+    for (std::uint32_t s = side >> 1; s > 0; s >>= 1)
+    {
+        std::uint32_t rx = (x & s) ? 1 : 0;
+        std::uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+vertex_ordering hilbertOrder(const std::vector<std::pair<double, double>> &coordinates)
+{
+    int n = coordinates.size();
+    if (n == 0)
+    {
+        return vertex_ordering();
+    }
+
+    // bounding box of the coordinates, used to scale them to the grid
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (const auto &c : coordinates)
+    {
+        minX = std::min(minX, c.first);
+        maxX = std::max(maxX, c.first);
+        minY = std::min(minY, c.second);
+        maxY = std::max(maxY, c.second);
+    }
+    double scaleX = maxX > minX ? 65535.0 / (maxX - minX) : 0.0;
+    double scaleY = maxY > minY ? 65535.0 / (maxY - minY) : 0.0;
+
+    // pair of <curve index, vertex>
+    std::vector<std::pair<std::uint64_t, int>> keys(n);
+    for (int v = 0; v < n; ++v)
+    {
+        std::uint32_t x = (coordinates[v].first - minX) * scaleX;
+        std::uint32_t y = (coordinates[v].second - minY) * scaleY;
+        keys[v] = std::make_pair(hilbertIndex(x, y), v);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i)
+    {
+        order[i] = keys[i].second;
+    }
+    return vertex_ordering(order);
+}
@@ -0,0 +1,453 @@
+#include "../include/hub_labels.h"
+#include "../include/search_workspace.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+typedef std::pair<int, int> iPair;
+
+// pairs of <hub rank, distance>, sorted by rank
+typedef std::vector<iPair> label_list;
+
+static const char fileMagic[8] = {'D', 'W', 'G', 'H', 'U', 'B', '0', '1'};
+
+/*
+ * Scratch state of one thread of the construction.
+ */
+struct pll_worker
+{
+    search_workspace workspace;
+    // distances from/to the current root by hub rank, "infinity" for
+    // the hubs that are not in the root's label.
+    std::vector<int> rootLabel;
+    // labels found by the search, pairs of <vertex, distance>
+    std::vector<iPair> found;
+};
+
+/*
+ * Pruned Dijkstra search from `root` (of rank `rank`) over `g`.
+ * `rootSide` are the labels of the root that point the same way as
+ * the search and `targetSide` the labels of the reached vertices
+ * that point the other way; a vertex is pruned when the two already
+ * give a path at least as short as the one found by the search.
+ */
+static void prunedSearch(const csr_graph &g, int root, const label_list &rootSide,
+                         const std::vector<label_list> &targetSide, pll_worker &w)
+{
+    const int inf = std::numeric_limits<int>::max();
+    for (const auto &l : rootSide)
+    {
+        w.rootLabel[l.first] = l.second;
+    }
+
+    w.found.clear();
+    w.workspace.reset(g.countVertices());
+    heap<iPair> &minHeap = w.workspace.queue();
+    minHeap.insert(std::make_pair(0, root));
+    w.workspace.setDistance(root, 0);
+
+    while (!minHeap.empty())
+    {
+        auto up = minHeap.pop();
+        int u = up.second;
+        int du = up.first;
+        if (du > w.workspace.distance(u))
+        {
+            continue;
+        }
+
+        // prune if the labels computed so far already cover u
+        bool covered = false;
+        for (const auto &l : targetSide[u])
+        {
+            if (w.rootLabel[l.first] != inf &&
+                static_cast<long long>(w.rootLabel[l.first]) + l.second <= du)
+            {
+                covered = true;
+                break;
+            }
+        }
+        if (covered)
+        {
+            continue;
+        }
+        w.found.emplace_back(u, du);
+
+        const int *targets = g.targets(u);
+        const int *weights = g.weights(u);
+        for (int i = 0; i < g.degree(u); ++i)
+        {
+            int v = targets[i];
+            if (du + weights[i] < w.workspace.distance(v))
+            {
+                w.workspace.setDistance(v, du + weights[i]);
+                minHeap.insert(std::make_pair(du + weights[i], v));
+            }
+        }
+    }
+
+    for (const auto &l : rootSide)
+    {
+        w.rootLabel[l.first] = inf;
+    }
+    return;
+}
+
+/*
+ * Hub order: vertices that lie on many shortest paths make the best
+ * hubs, they cover many pairs early and prune later searches. The
+ * number of shortest paths through a vertex is estimated from the
+ * subtree sizes of the shortest path trees of a few sample roots;
+ * ties (and vertices no tree passed through) go by degree.
+ */
+static std::vector<int> hubOrder(const csr_graph &g, const csr_graph &reverse, bool symmetric)
+{
+    const int samples = 16;
+    int n = g.countVertices();
+    std::vector<long long> score(n, 0);
+    std::vector<int> parent(n), settled;
+    search_workspace workspace;
+
+    for (int s = 0; s < samples && s < n; ++s)
+    {
+        // spread the sample roots evenly over the vertex labels
+        int root = static_cast<long long>(s) * n / std::min(samples, n);
+
+        settled.clear();
+        workspace.reset(n);
+        heap<iPair> &minHeap = workspace.queue();
+        minHeap.insert(std::make_pair(0, root));
+        workspace.setDistance(root, 0);
+        parent[root] = -1;
+        while (!minHeap.empty())
+        {
+            auto up = minHeap.pop();
+            int u = up.second;
+            if (up.first > workspace.distance(u))
+            {
+                continue;
+            }
+            settled.push_back(u);
+            for (int i = 0; i < g.degree(u); ++i)
+            {
+                int v = g.targets(u)[i];
+                int dv = up.first + g.weights(u)[i];
+                if (dv < workspace.distance(v))
+                {
+                    workspace.setDistance(v, dv);
+                    parent[v] = u;
+                    minHeap.insert(std::make_pair(dv, v));
+                }
+            }
+        }
+
+        // subtree sizes, accumulated from the leaves up
+        std::vector<long long> subtree(settled.size(), 1);
+        std::vector<int> position(n);
+        for (std::size_t i = 0; i < settled.size(); ++i)
+        {
+            position[settled[i]] = i;
+        }
+        for (std::size_t i = settled.size(); i-- > 1;)
+        {
+            subtree[position[parent[settled[i]]]] += subtree[i];
+        }
+        for (std::size_t i = 0; i < settled.size(); ++i)
+        {
+            score[settled[i]] += subtree[i];
+        }
+    }
+
+    std::vector<int> order(n);
+    for (int v = 0; v < n; ++v)
+    {
+        order[v] = v;
+    }
+    auto degree = [&](int v) { return g.degree(v) + (symmetric ? 0 : reverse.degree(v)); };
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return score[a] != score[b] ? score[a] > score[b] : degree(a) > degree(b);
+    });
+    return order;
+}
+
+hub_labels::hub_labels(const directed_weighted_graph &g, int threads)
+{
+    build(csr_graph(g), false, threads);
+}
+
+hub_labels::hub_labels(const undirected_weighted_graph &g, int threads)
+{
+    build(csr_graph(g), true, threads);
+}
+
+void hub_labels::build(const csr_graph &g, bool symmetric, int threads)
+{
+    m_symmetric = symmetric;
+    int n = g.countVertices();
+    csr_graph reverse = symmetric ? csr_graph() : g.reversed();
+    if (threads <= 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<int> order = hubOrder(g, reverse, symmetric);
+
+    // in[v] holds <hub, d(hub, v)>, out[v] holds <hub, d(v, hub)>. An
+    // undirected graph uses a single list for both.
+    std::vector<label_list> in(n), out(symmetric ? 0 : n);
+    std::vector<label_list> &outRef = symmetric ? in : out;
+
+    std::vector<pll_worker> workers(threads);
+    for (auto &w : workers)
+    {
+        w.rootLabel.assign(n, std::numeric_limits<int>::max());
+    }
+
+    for (int first = 0; first < n; first += threads)
+    {
+        int batch = std::min(threads, n - first);
+
+        // every worker searches from one hub of the batch, reading
+        // only the labels committed by the previous batches.
+        std::vector<std::vector<iPair>> forwardFound(batch), backwardFound(batch);
+        auto search = [&](int i) {
+            int rank = first + i;
+            int root = order[rank];
+            prunedSearch(g, root, outRef[root], in, workers[i]);
+            forwardFound[i].swap(workers[i].found);
+            if (!symmetric)
+            {
+                prunedSearch(reverse, root, in[root], out, workers[i]);
+                backwardFound[i].swap(workers[i].found);
+            }
+        };
+
+        if (batch == 1)
+        {
+            search(0);
+        }
+        else
+        {
+            std::vector<std::thread> pool;
+            for (int i = 0; i < batch; ++i)
+            {
+                pool.emplace_back(search, i);
+            }
+            for (auto &t : pool)
+            {
+                t.join();
+            }
+        }
+
+        // commit in rank order, which keeps every label sorted
+        for (int i = 0; i < batch; ++i)
+        {
+            for (const auto &f : forwardFound[i])
+            {
+                in[f.first].emplace_back(first + i, f.second);
+            }
+            for (const auto &f : backwardFound[i])
+            {
+                out[f.first].emplace_back(first + i, f.second);
+            }
+        }
+    }
+
+    // flatten the labels into the compact arrays
+    auto flatten = [n](std::vector<label_list> &labels, label_set &set) {
+        set.offsets.assign(1, 0);
+        set.hubs.clear();
+        set.distances.clear();
+        for (int v = 0; v < n; ++v)
+        {
+            for (const auto &l : labels[v])
+            {
+                set.hubs.push_back(l.first);
+                set.distances.push_back(l.second);
+            }
+            set.offsets.push_back(set.hubs.size());
+            label_list().swap(labels[v]);
+        }
+    };
+    m_in = label_set();
+    flatten(outRef, m_out);
+    if (!symmetric)
+    {
+        flatten(in, m_in);
+    }
+    return;
+}
+
+int hub_labels::distance(int source, int target) const
+{
+    const int inf = std::numeric_limits<int>::max();
+    if (source < 0 || source >= countVertices() || target < 0 || target >= countVertices())
+    {
+        return inf;
+    }
+
+    const label_set &in = m_symmetric ? m_out : m_in;
+    std::uint64_t i = m_out.offsets[source], iEnd = m_out.offsets[source + 1];
+    std::uint64_t j = in.offsets[target], jEnd = in.offsets[target + 1];
+
+    // merge join on the hub ranks
+    long long best = inf;
+    while (i < iEnd && j < jEnd)
+    {
+        int a = m_out.hubs[i];
+        int b = in.hubs[j];
+        if (a == b)
+        {
+            best = std::min(best, static_cast<long long>(m_out.distances[i]) + in.distances[j]);
+            ++i;
+            ++j;
+        }
+        else if (a < b)
+        {
+            ++i;
+        }
+        else
+        {
+            ++j;
+        }
+    }
+    return best;
+}
+
+int hub_labels::countVertices() const
+{
+    return m_out.offsets.empty() ? 0 : m_out.offsets.size() - 1;
+}
+
+std::size_t hub_labels::countEntries() const
+{
+    return m_out.hubs.size() + m_in.hubs.size();
+}
+
+static void writeSet(std::ofstream &file, const std::vector<std::uint64_t> &offsets,
+                     const std::vector<int> &hubs, const std::vector<int> &distances)
+{
+    std::uint64_t sizes[2] = {offsets.size(), hubs.size()};
+    file.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+    file.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    file.write(reinterpret_cast<const char *>(hubs.data()), hubs.size() * sizeof(int));
+    file.write(reinterpret_cast<const char *>(distances.data()), distances.size() * sizeof(int));
+    return;
+}
+
+static bool readSet(std::ifstream &file, std::vector<std::uint64_t> &offsets,
+                    std::vector<int> &hubs, std::vector<int> &distances)
+{
+    std::uint64_t sizes[2];
+    if (!file.read(reinterpret_cast<char *>(sizes), sizeof(sizes)))
+    {
+        return false;
+    }
+
+    // the sizes are checked against what is left of the file before
+    // anything gets allocated.
+    std::streampos position = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::uint64_t left = file.tellg() - position;
+    file.seekg(position);
+    if (sizes[0] > left / sizeof(std::uint64_t) ||
+        sizes[1] > (left - sizes[0] * sizeof(std::uint64_t)) / (2 * sizeof(int)) ||
+        sizes[0] > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) + 1)
+    {
+        return false;
+    }
+
+    offsets.resize(sizes[0]);
+    hubs.resize(sizes[1]);
+    distances.resize(sizes[1]);
+    file.read(reinterpret_cast<char *>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char *>(hubs.data()), hubs.size() * sizeof(int));
+    file.read(reinterpret_cast<char *>(distances.data()), distances.size() * sizeof(int));
+    if (!file)
+    {
+        return false;
+    }
+    if (offsets.empty())
+    {
+        return hubs.empty();
+    }
+
+    // every label must lie inside the hub array and be sorted by
+    // rank, as the merge join of distance() expects.
+    if (offsets.front() != 0 || offsets.back() != hubs.size())
+    {
+        return false;
+    }
+    int vertices = offsets.size() - 1;
+    for (int v = 0; v < vertices; ++v)
+    {
+        if (offsets[v] > offsets[v + 1])
+        {
+            return false;
+        }
+        for (std::uint64_t i = offsets[v]; i < offsets[v + 1]; ++i)
+        {
+            if (hubs[i] < 0 || hubs[i] >= vertices || distances[i] < 0 ||
+                (i > offsets[v] && hubs[i] <= hubs[i - 1]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool hub_labels::write(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    char symmetric = m_symmetric;
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write(&symmetric, 1);
+    writeSet(file, m_out.offsets, m_out.hubs, m_out.distances);
+    writeSet(file, m_in.offsets, m_in.hubs, m_in.distances);
+    return file.good();
+}
+
+bool hub_labels::read(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    char magic[sizeof(fileMagic)];
+    char symmetric;
+    file.read(magic, sizeof(magic));
+    file.read(&symmetric, 1);
+    if (!file || !std::equal(magic, magic + sizeof(magic), fileMagic))
+    {
+        return false;
+    }
+
+    label_set out, in;
+    if (!readSet(file, out.offsets, out.hubs, out.distances) ||
+        !readSet(file, in.offsets, in.hubs, in.distances))
+    {
+        return false;
+    }
+    if (symmetric ? !in.offsets.empty() : in.offsets.size() != out.offsets.size())
+    {
+        return false;
+    }
+
+    m_symmetric = symmetric;
+    m_out.offsets.swap(out.offsets);
+    m_out.hubs.swap(out.hubs);
+    m_out.distances.swap(out.distances);
+    m_in.offsets.swap(in.offsets);
+    m_in.hubs.swap(in.hubs);
+    m_in.distances.swap(in.distances);
+    return true;
+}
@@ -0,0 +1,364 @@
+#include "../include/partition_overlay.h"
+#include "../include/graph_partition.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+typedef std::pair<int, int> iPair;
+
+static const int defaultCellSizes[] = {1 << 8, 1 << 11, 1 << 14};
+
+partition_overlay::partition_overlay(const graph &g, int threads)
+    : partition_overlay(csr_graph(g), threads)
+{
+}
+
+partition_overlay::partition_overlay(const csr_graph &g, int threads)
+    : partition_overlay(g, std::vector<int>(std::begin(defaultCellSizes), std::end(defaultCellSizes)),
+                        threads)
+{
+}
+
+partition_overlay::partition_overlay(const csr_graph &g, const std::vector<int> &cellSizes,
+                                     int threads)
+    : m_graph(g), m_threads(threads)
+{
+    int n = m_graph.countVertices();
+    m_weights.reserve(m_graph.countEdges());
+    for (int v = 0; v < n; ++v)
+    {
+        m_weights.insert(m_weights.end(), m_graph.weights(v), m_graph.weights(v) + m_graph.degree(v));
+    }
+    if (m_threads <= 0)
+    {
+        m_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // metric independent phase: the cells of every level, and their
+    // boundary vertices.
+    csr_graph reverse = m_graph.reversed();
+    std::vector<std::vector<int>> cells = partitionGraph(m_graph, cellSizes);
+    m_levels.resize(cells.size());
+    for (std::size_t l = 0; l < cells.size(); ++l)
+    {
+        overlay_level &level = m_levels[l];
+        level.cell.swap(cells[l]);
+
+        int count = 0;
+        for (int c : level.cell)
+        {
+            count = std::max(count, c + 1);
+        }
+        level.cellOffsets.assign(count + 1, 0);
+        for (int c : level.cell)
+        {
+            ++level.cellOffsets[c + 1];
+        }
+        for (int c = 0; c < count; ++c)
+        {
+            level.cellOffsets[c + 1] += level.cellOffsets[c];
+        }
+        level.cellVertices.resize(n);
+        std::vector<std::size_t> next(level.cellOffsets.begin(), level.cellOffsets.end() - 1);
+        for (int v = 0; v < n; ++v)
+        {
+            level.cellVertices[next[level.cell[v]]++] = v;
+        }
+
+        auto crosses = [&level](const csr_graph &g, int v) {
+            for (int i = 0; i < g.degree(v); ++i)
+            {
+                if (level.cell[g.targets(v)[i]] != level.cell[v])
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        level.boundaryIndex.assign(n, -1);
+        level.boundaryOffsets.assign(1, 0);
+        level.cliqueOffsets.assign(1, 0);
+        for (int c = 0; c < count; ++c)
+        {
+            for (std::size_t i = level.cellOffsets[c]; i < level.cellOffsets[c + 1]; ++i)
+            {
+                int v = level.cellVertices[i];
+                if (crosses(m_graph, v) || crosses(reverse, v))
+                {
+                    level.boundaryIndex[v] = level.boundary.size() - level.boundaryOffsets[c];
+                    level.boundary.push_back(v);
+                }
+            }
+            std::size_t b = level.boundary.size() - level.boundaryOffsets[c];
+            level.boundaryOffsets.push_back(level.boundary.size());
+            level.cliqueOffsets.push_back(level.cliqueOffsets[c] + b * b);
+        }
+        level.clique.resize(level.cliqueOffsets.back());
+
+        // first customization of every cell
+        level.dirty.assign(count, 1);
+    }
+    customize();
+}
+
+/*
+ * Lowers the distance of `v` to `dv` and queues it, if that is an
+ * improvement.
+ */
+struct overlay_relax
+{
+    search_workspace &workspace;
+    heap<iPair> &minHeap;
+
+    void operator()(int v, int dv) const
+    {
+        if (dv < workspace.distance(v))
+        {
+            workspace.setDistance(v, dv);
+            minHeap.insert(std::make_pair(dv, v));
+        }
+    }
+};
+
+template <class Arcs>
+int partition_overlay::search(int source, int target, search_workspace &workspace, Arcs arcs) const
+{
+    workspace.reset(countVertices());
+    heap<iPair> &minHeap = workspace.queue();
+    minHeap.insert(std::make_pair(0, source));
+    workspace.setDistance(source, 0);
+    overlay_relax relax{workspace, minHeap};
+
+    while (!minHeap.empty())
+    {
+        auto up = minHeap.pop();
+        int u = up.second;
+        int du = up.first;
+        // skip stale entries
+        if (du > workspace.distance(u))
+        {
+            continue;
+        }
+        if (u == target)
+        {
+            return du;
+        }
+        arcs(u, du, relax);
+    }
+    return std::numeric_limits<int>::max();
+}
+
+/*
+ * Calls f(v, distance) for every finite clique arc from the boundary
+ * vertex `vertex` of its cell at `level`.
+ */
+template <class Function>
+void partition_overlay::forEachCliqueArc(int level, int vertex, Function f) const
+{
+    const overlay_level &l = m_levels[level];
+    int c = l.cell[vertex];
+    std::size_t first = l.boundaryOffsets[c];
+    std::size_t b = l.boundaryOffsets[c + 1] - first;
+    const int *row = l.clique.data() + l.cliqueOffsets[c] + l.boundaryIndex[vertex] * b;
+    for (std::size_t j = 0; j < b; ++j)
+    {
+        if (row[j] != std::numeric_limits<int>::max())
+        {
+            f(l.boundary[first + j], row[j]);
+        }
+    }
+    return;
+}
+
+/*
+ * Fills the clique of `cell` at `level` with one search per boundary
+ * vertex, restricted to the cell. The lowest level searches the
+ * original edges inside the cell; higher levels search the boundary
+ * vertices of the subcells, over the subcell cliques and the original
+ * edges between subcells.
+ */
+void partition_overlay::customizeCell(int level, int cell, search_workspace &workspace)
+{
+    overlay_level &l = m_levels[level];
+    const std::vector<int> &cells = l.cell;
+    const std::vector<int> *subcells = level > 0 ? &m_levels[level - 1].cell : nullptr;
+    std::size_t first = l.boundaryOffsets[cell];
+    std::size_t b = l.boundaryOffsets[cell + 1] - first;
+    int *clique = l.clique.data() + l.cliqueOffsets[cell];
+
+    auto arcs = [this, level, cell, &cells, subcells](int u, int du, const overlay_relax &relax) {
+        if (subcells)
+        {
+            forEachCliqueArc(level - 1, u, [du, &relax](int v, int d) { relax(v, du + d); });
+        }
+        std::size_t e = m_graph.firstEdge(u);
+        const int *targets = m_graph.targets(u);
+        for (int i = 0; i < m_graph.degree(u); ++i)
+        {
+            int v = targets[i];
+            if (cells[v] == cell && (!subcells || (*subcells)[v] != (*subcells)[u]))
+            {
+                relax(v, du + m_weights[e + i]);
+            }
+        }
+    };
+
+    for (std::size_t i = 0; i < b; ++i)
+    {
+        // the search has no target, it runs until the cell is done
+        search(l.boundary[first + i], -1, workspace, arcs);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            clique[i * b + j] = workspace.distance(l.boundary[first + j]);
+        }
+    }
+    return;
+}
+
+int partition_overlay::customize()
+{
+    int total = 0;
+    for (int level = 0; level < countLevels(); ++level)
+    {
+        overlay_level &l = m_levels[level];
+        std::vector<int> dirty;
+        for (int c = 0; c < countCells(level); ++c)
+        {
+            if (l.dirty[c])
+            {
+                dirty.push_back(c);
+                l.dirty[c] = 0;
+            }
+        }
+
+        // the cells write disjoint parts of the clique array, so the
+        // threads just pull cells off a shared counter.
+        std::atomic<std::size_t> nextCell(0);
+        auto work = [this, level, &dirty, &nextCell]() {
+            search_workspace workspace;
+            std::size_t i;
+            while ((i = nextCell++) < dirty.size())
+            {
+                customizeCell(level, dirty[i], workspace);
+            }
+        };
+
+        int threads = std::min<std::size_t>(m_threads, dirty.size());
+        if (threads <= 1)
+        {
+            work();
+        }
+        else
+        {
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; ++t)
+            {
+                pool.emplace_back(work);
+            }
+            for (auto &t : pool)
+            {
+                t.join();
+            }
+        }
+
+        // the cliques of the level above are built on these ones
+        if (level + 1 < countLevels())
+        {
+            for (int c : dirty)
+            {
+                int v = l.cellVertices[l.cellOffsets[c]];
+                m_levels[level + 1].dirty[m_levels[level + 1].cell[v]] = 1;
+            }
+        }
+        total += dirty.size();
+    }
+    return total;
+}
+
+bool partition_overlay::updateWeight(int source, int dest, int weight)
+{
+    if (source < 0 || source >= countVertices())
+    {
+        return false;
+    }
+
+    bool found = false;
+    std::size_t e = m_graph.firstEdge(source);
+    const int *targets = m_graph.targets(source);
+    for (int i = 0; i < m_graph.degree(source); ++i)
+    {
+        if (targets[i] == dest)
+        {
+            m_weights[e + i] = weight;
+            found = true;
+        }
+    }
+
+    // the edge is only used by the cliques of the lowest level cell
+    // containing both ends (and, through it, of the cells above). An
+    // edge between top level cells is used as is by the queries.
+    for (int level = 0; found && level < countLevels(); ++level)
+    {
+        overlay_level &l = m_levels[level];
+        if (l.cell[source] == l.cell[dest])
+        {
+            l.dirty[l.cell[source]] = 1;
+            break;
+        }
+    }
+    return found;
+}
+
+int partition_overlay::distance(int source, int target) const
+{
+    search_workspace workspace;
+    return distance(source, target, workspace);
+}
+
+int partition_overlay::distance(int source, int target, search_workspace &workspace) const
+{
+    int n = countVertices();
+    if (source < 0 || source >= n || target < 0 || target >= n)
+    {
+        throw std::out_of_range("partition_overlay: vertex not in graph");
+    }
+
+    auto arcs = [this, source, target](int u, int du, const overlay_relax &relax) {
+        // the highest level whose cell of u contains neither endpoint,
+        // the cells of the levels below it do not either.
+        int level = countLevels() - 1;
+        while (level >= 0)
+        {
+            const std::vector<int> &cells = m_levels[level].cell;
+            if (cells[u] != cells[source] && cells[u] != cells[target])
+            {
+                break;
+            }
+            --level;
+        }
+
+        // u is then a boundary vertex of that cell (the search can
+        // only enter it through one), which is crossed on its clique.
+        // Vertices in the lowest level cells of the endpoints use all
+        // their original edges.
+        if (level >= 0)
+        {
+            forEachCliqueArc(level, u, [du, &relax](int v, int d) { relax(v, du + d); });
+        }
+        const std::vector<int> *cells = level >= 0 ? &m_levels[level].cell : nullptr;
+        std::size_t e = m_graph.firstEdge(u);
+        const int *targets = m_graph.targets(u);
+        for (int i = 0; i < m_graph.degree(u); ++i)
+        {
+            int v = targets[i];
+            if (!cells || (*cells)[v] != (*cells)[u])
+            {
+                relax(v, du + m_weights[e + i]);
+            }
+        }
+    };
+    return search(source, target, workspace, arcs);
+}
@@ -0,0 +1,128 @@
+#include "../include/path_cache.h"
+
+path_cache::path_cache(const graph &g, std::size_t capacity)
+    : m_graph(g), m_capacity(capacity), m_version(g.version()),
+      m_metrics{0, 0, 0, 0, 0}
+{
+}
+
+std::shared_ptr<const std::vector<int>> path_cache::distances(int source)
+{
+    std::shared_ptr<const shortestPath> solver;
+    std::uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        syncVersion();
+
+        auto it = m_entries.find(source);
+        if (it != m_entries.end())
+        {
+            // move the entry to the front of the LRU list
+            ++m_metrics.hits;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+            return it->second.first;
+        }
+        ++m_metrics.misses;
+        solver = m_solver;
+        version = m_version;
+    }
+
+    // the solver copies the graph, it is built once per version and
+    // shared by all the misses of that version.
+    if (!solver)
+    {
+        solver = buildSolver(version);
+    }
+
+    result distances = std::make_shared<const std::vector<int>>(solver->compute(source));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    syncVersion();
+    // don't cache a result computed for an older version of the graph
+    if (version == m_version)
+    {
+        insert(source, distances);
+    }
+    return distances;
+}
+
+path_cache::metrics path_cache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    metrics current = m_metrics;
+    current.entries = m_entries.size();
+    return current;
+}
+
+void path_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_solver.reset();
+    return;
+}
+
+void path_cache::syncVersion()
+{
+    std::uint64_t version = m_graph.version();
+    if (version == m_version)
+    {
+        return;
+    }
+
+    m_version = version;
+    m_solver.reset();
+    if (!m_entries.empty())
+    {
+        ++m_metrics.invalidations;
+        m_entries.clear();
+        m_lru.clear();
+    }
+    return;
+}
+
+std::shared_ptr<const shortestPath> path_cache::buildSolver(std::uint64_t version)
+{
+    std::lock_guard<std::mutex> build(m_buildMutex);
+    {
+        // another miss may have built it while this one was waiting
+        std::lock_guard<std::mutex> lock(m_mutex);
+        syncVersion();
+        if (m_solver && version == m_version)
+        {
+            return m_solver;
+        }
+    }
+
+    std::shared_ptr<const shortestPath> built = std::make_shared<const shortestPath>(m_graph);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    syncVersion();
+    // a solver built after the graph changed is used for this miss
+    // only, its result is not cached anyway.
+    if (version == m_version)
+    {
+        m_solver = built;
+    }
+    return built;
+}
+
+void path_cache::insert(int source, const result &distances)
+{
+    // another thread may have computed the same source meanwhile
+    if (m_capacity == 0 || m_entries.find(source) != m_entries.end())
+    {
+        return;
+    }
+
+    if (m_entries.size() == m_capacity)
+    {
+        ++m_metrics.evictions;
+        m_entries.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+    m_lru.push_front(source);
+    m_entries.emplace(source, std::make_pair(distances, m_lru.begin()));
+    return;
+}
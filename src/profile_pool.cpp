@@ -0,0 +1,152 @@
+#include "../include/profile_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+profile_pool::profile_pool(int period) : m_period(period), m_offsets(1, 0)
+{
+    if (period <= 0)
+    {
+        throw std::invalid_argument("profile_pool: period must be positive");
+    }
+}
+
+int profile_pool::addProfile(const std::vector<std::pair<int, int>> &points)
+{
+    if (points.empty())
+    {
+        throw std::invalid_argument("profile_pool: empty profile");
+    }
+
+    // FIFO means arrival = time + travel time never decreases along
+    // a segment, including the one wrapping around to the next period.
+    std::size_t k = points.size();
+    for (std::size_t i = 0; i < k; ++i)
+    {
+        const auto &p = points[i];
+        if (p.first < 0 || p.first >= m_period || p.second < 0)
+        {
+            throw std::invalid_argument("profile_pool: breakpoint out of range");
+        }
+        if (i > 0 && p.first <= points[i - 1].first)
+        {
+            throw std::invalid_argument("profile_pool: breakpoint times must be increasing");
+        }
+        const auto &next = points[(i + 1) % k];
+        long long nextTime = next.first + (i + 1 == k ? static_cast<long long>(m_period) : 0);
+        if (k > 1 && nextTime + next.second < p.first + static_cast<long long>(p.second))
+        {
+            throw std::invalid_argument("profile_pool: profile is not FIFO");
+        }
+    }
+
+    // merge with an identical profile (FNV-1a over the breakpoints)
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const auto &p : points)
+    {
+        hash = (hash ^ static_cast<std::uint32_t>(p.first)) * 1099511628211ull;
+        hash = (hash ^ static_cast<std::uint32_t>(p.second)) * 1099511628211ull;
+    }
+    auto range = m_index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        std::uint32_t begin = m_offsets[it->second];
+        if (m_offsets[it->second + 1] - begin != k)
+        {
+            continue;
+        }
+        bool same = true;
+        for (std::size_t i = 0; i < k && same; ++i)
+        {
+            same = m_times[begin + i] == points[i].first && m_values[begin + i] == points[i].second;
+        }
+        if (same)
+        {
+            return it->second;
+        }
+    }
+
+    int id = size();
+    for (const auto &p : points)
+    {
+        m_times.push_back(p.first);
+        m_values.push_back(p.second);
+    }
+    m_offsets.push_back(m_times.size());
+    m_index.emplace(hash, id);
+    return id;
+}
+
+int profile_pool::addConstant(int travelTime)
+{
+    return addProfile(std::vector<std::pair<int, int>>(1, std::make_pair(0, travelTime)));
+}
+
+/*
+ * Index of the last of the `count` sorted `times` that is <= `t`, or
+ * -1 if there is none. A branchless binary search narrows long
+ * profiles down to a short window, which is then scanned with a
+ * branchless count the compiler turns into SIMD compares.
+ */
+static int lastBreakpoint(const int *times, int count, int t)
+{
+    const int window = 16;
+    int base = 0;
+    while (count > window)
+    {
+        int half = count / 2;
+        base = times[base + half] <= t ? base + half : base;
+        count -= half;
+    }
+
+    int below = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        below += times[base + i] <= t;
+    }
+    return base + below - 1;
+}
+
+int profile_pool::evaluate(int profile, int time) const
+{
+    std::uint32_t begin = m_offsets[profile];
+    int k = m_offsets[profile + 1] - begin;
+    const int *times = m_times.data() + begin;
+    const int *values = m_values.data() + begin;
+    if (k == 1)
+    {
+        return values[0];
+    }
+
+    // find the segment around t; before the first breakpoint it is
+    // the one wrapping around from the previous period.
+    int t = time % m_period;
+    int i = lastBreakpoint(times, k, t);
+    long long t0, t1;
+    int v0, v1;
+    if (i < 0)
+    {
+        t0 = times[k - 1] - static_cast<long long>(m_period);
+        v0 = values[k - 1];
+        t1 = times[0];
+        v1 = values[0];
+    }
+    else
+    {
+        t0 = times[i];
+        v0 = values[i];
+        t1 = i + 1 < k ? times[i + 1] : times[0] + static_cast<long long>(m_period);
+        v1 = values[i + 1 < k ? i + 1 : 0];
+    }
+
+    // rounding down keeps the integer profile FIFO
+    long long num = static_cast<long long>(v1 - v0) * (t - t0);
+    long long span = t1 - t0;
+    long long step = num >= 0 ? num / span : -((-num + span - 1) / span);
+    return v0 + step;
+}
+
+std::size_t profile_pool::memoryUsage() const
+{
+    return (m_times.size() + m_values.size()) * sizeof(int) +
+           m_offsets.size() * sizeof(std::uint32_t);
+}
@@ -0,0 +1,475 @@
+#include "../include/query_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+query_server::query_server(const graph &g, int threads)
+    : query_server(std::make_shared<const shortestPath>(g), threads)
+{
+}
+
+query_server::query_server(std::shared_ptr<const shortestPath> solver, int threads)
+    : m_solver(solver), m_stopping(false),
+      m_metrics{0, 0, 0, 0, 0, std::vector<std::uint64_t>(latencyBuckets, 0)},
+      m_listening(false), m_stopRequested(false), m_listener(-1)
+{
+    if (threads <= 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int t = 0; t < threads; ++t)
+    {
+        m_workers.emplace_back(&query_server::work, this);
+    }
+}
+
+query_server::~query_server()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto &t : m_workers)
+    {
+        t.join();
+    }
+}
+
+void query_server::submit(const request &r, completion done)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(r.source);
+        if (it == m_pending.end())
+        {
+            // first request for that source, it joins the queue
+            m_sources.push_back(r.source);
+            it = m_pending.emplace(r.source, std::vector<pending_request>()).first;
+        }
+        it->second.push_back(pending_request{r, std::move(done), clock::now()});
+
+        ++m_metrics.requests;
+        ++m_metrics.queueDepth;
+        m_metrics.maxQueueDepth = std::max(m_metrics.maxQueueDepth, m_metrics.queueDepth);
+    }
+    m_wake.notify_one();
+    return;
+}
+
+void query_server::work()
+{
+    while (true)
+    {
+        // take every request waiting for the oldest queued source, the
+        // queue is drained before the workers stop.
+        int source;
+        std::vector<pending_request> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_sources.empty(); });
+            if (m_sources.empty())
+            {
+                return;
+            }
+            source = m_sources.front();
+            m_sources.pop_front();
+            auto it = m_pending.find(source);
+            batch.swap(it->second);
+            m_pending.erase(it);
+            m_metrics.queueDepth -= batch.size();
+            ++m_metrics.batches;
+        }
+
+        result shared{0, source, -1, true, 0, nullptr, std::string()};
+        try
+        {
+            shared.distances = std::make_shared<const std::vector<int>>(m_solver->compute(source));
+        }
+        catch (const std::exception &e)
+        {
+            shared.ok = false;
+            shared.error = e.what();
+        }
+
+        for (const auto &p : batch)
+        {
+            result res = shared;
+            res.id = p.r.id;
+            res.target = p.r.target;
+            if (res.ok && res.target >= 0)
+            {
+                if (res.target < static_cast<int>(shared.distances->size()))
+                {
+                    res.distance = (*shared.distances)[res.target];
+                }
+                else
+                {
+                    res.ok = false;
+                    res.error = "target vertex not in graph";
+                }
+            }
+            complete(p, res);
+        }
+    }
+}
+
+void query_server::complete(const pending_request &p, const result &res)
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - p.queued)
+                      .count();
+    int bucket = 0;
+    while (bucket + 1 < latencyBuckets && (micros >> (bucket + 1)) > 0)
+    {
+        ++bucket;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_metrics.completed;
+        ++m_metrics.latency[bucket];
+    }
+    p.done(res);
+    return;
+}
+
+query_server::metrics query_server::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_metrics;
+}
+
+/*
+ * Writes all of `text` to `fd`, returns false on error. Sockets are
+ * written with MSG_NOSIGNAL, so that a client that disconnects before
+ * reading its answers fails its own stream (EPIPE) instead of killing
+ * the process with SIGPIPE; other descriptors fall back to write.
+ */
+static bool writeAll(int fd, const std::string &text)
+{
+    bool socket = true;
+    std::size_t written = 0;
+    while (written < text.size())
+    {
+        const char *data = text.data() + written;
+        std::size_t size = text.size() - written;
+        ssize_t n = socket ? ::send(fd, data, size, MSG_NOSIGNAL) : ::write(fd, data, size);
+        if (n < 0 && socket && errno == ENOTSOCK)
+        {
+            socket = false;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+static void appendDistance(std::string &out, int distance)
+{
+    out += ' ';
+    out += distance == std::numeric_limits<int>::max() ? "inf" : std::to_string(distance);
+    return;
+}
+
+static std::string formatResult(const query_server::result &res)
+{
+    std::string out = std::to_string(res.id);
+    if (!res.ok)
+    {
+        return out + " error " + res.error + "\n";
+    }
+
+    out += " ok";
+    if (res.target >= 0)
+    {
+        appendDistance(out, res.distance);
+    }
+    else
+    {
+        out.reserve(out.size() + res.distances->size() * 8);
+        for (int d : *res.distances)
+        {
+            appendDistance(out, d);
+        }
+    }
+    return out + "\n";
+}
+
+static std::string formatStats(const query_server::metrics &m)
+{
+    std::ostringstream out;
+    out << "stats requests=" << m.requests << " completed=" << m.completed
+        << " batches=" << m.batches << " queue=" << m.queueDepth
+        << " max_queue=" << m.maxQueueDepth << " latency_us=";
+
+    // nonempty buckets as <lower bound>:<count>
+    bool first = true;
+    for (int i = 0; i < query_server::latencyBuckets; ++i)
+    {
+        if (m.latency[i] > 0)
+        {
+            out << (first ? "" : ",") << (i == 0 ? 0 : 1ull << i) << ':' << m.latency[i];
+            first = false;
+        }
+    }
+    out << "\n";
+    return out.str();
+}
+
+/*
+ * Output side of a served stream, shared with the completions of its
+ * requests: answers are written whole under the mutex, and the
+ * stream is done once no request is outstanding.
+ */
+struct stream_state
+{
+    int fd;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t outstanding;
+    bool failed;
+};
+
+bool query_server::serve(int input, int output)
+{
+    auto stream = std::make_shared<stream_state>();
+    stream->fd = output;
+    stream->outstanding = 0;
+    stream->failed = false;
+
+    auto reply = [stream](const std::string &text) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (!stream->failed && !writeAll(stream->fd, text))
+        {
+            stream->failed = true;
+        }
+    };
+
+    auto handle = [this, stream, &reply](const std::string &line) {
+        std::istringstream in(line);
+        std::string first;
+        if (!(in >> first))
+        {
+            return;
+        }
+        if (first == "stats")
+        {
+            reply(formatStats(stats()));
+            return;
+        }
+
+        request r{0, -1, -1};
+        std::istringstream id(first);
+        int target;
+        std::string extra;
+        bool valid = (id >> r.id) && id.eof() && (in >> r.source);
+        if (valid && (in >> target))
+        {
+            r.target = target;
+            valid = !(in >> extra);
+        }
+        else
+        {
+            valid = valid && in.eof();
+        }
+        if (!valid)
+        {
+            reply(first + " error malformed request\n");
+            return;
+        }
+        if (r.target < -1)
+        {
+            reply(first + " error target vertex not in graph\n");
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            ++stream->outstanding;
+        }
+        submit(r, [stream](const result &res) {
+            std::string text = formatResult(res);
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (!stream->failed && !writeAll(stream->fd, text))
+            {
+                stream->failed = true;
+            }
+            if (--stream->outstanding == 0)
+            {
+                stream->idle.notify_all();
+            }
+        });
+    };
+
+    // split the input in lines as it arrives
+    bool readError = false;
+    std::string pending;
+    char buffer[64 * 1024];
+    while (true)
+    {
+        ssize_t n = ::read(input, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            readError = n < 0;
+            break;
+        }
+        pending.append(buffer, n);
+        std::size_t begin = 0, end;
+        while ((end = pending.find('\n', begin)) != std::string::npos)
+        {
+            handle(pending.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        pending.erase(0, begin);
+    }
+    if (!pending.empty())
+    {
+        handle(pending);
+    }
+
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    stream->idle.wait(lock, [&stream]() { return stream->outstanding == 0; });
+    return !readError && !stream->failed;
+}
+
+bool query_server::serveUnix(const std::string &path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return false;
+    }
+    // a socket file left over by a previous run would make bind fail
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(listener, SOMAXCONN) < 0)
+    {
+        ::close(listener);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // stop() may have been called before the socket was set up
+        if (m_stopRequested)
+        {
+            m_stopRequested = false;
+            ::close(listener);
+            ::unlink(path.c_str());
+            return true;
+        }
+        m_listening = true;
+        m_listener = listener;
+    }
+
+    // connection threads, with a flag telling when they can be joined
+    std::list<std::pair<std::thread, std::shared_ptr<std::atomic<bool>>>> connections;
+    auto reap = [&connections](bool all) {
+        for (auto it = connections.begin(); it != connections.end();)
+        {
+            if (all || *it->second)
+            {
+                it->first.join();
+                it = connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    };
+
+    bool ok = true;
+    while (true)
+    {
+        int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_listening)
+            {
+                break;
+            }
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_connections.push_back(connection);
+        }
+        reap(false);
+        auto finished = std::make_shared<std::atomic<bool>>(false);
+        connections.emplace_back(std::thread([this, connection, finished]() {
+                                     serve(connection, connection);
+                                     {
+                                         std::lock_guard<std::mutex> lock(m_mutex);
+                                         m_connections.erase(std::find(m_connections.begin(),
+                                                                       m_connections.end(),
+                                                                       connection));
+                                     }
+                                     ::close(connection);
+                                     *finished = true;
+                                 }),
+                                 finished);
+    }
+
+    reap(true);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_listening = false;
+        m_stopRequested = false;
+        m_listener = -1;
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+    return ok;
+}
+
+void query_server::stop()
+{
+    // shutting the sockets down wakes up the blocked accept and reads,
+    // the requests already read are still answered.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_listening = false;
+    m_stopRequested = true;
+    if (m_listener >= 0)
+    {
+        ::shutdown(m_listener, SHUT_RDWR);
+    }
+    for (int connection : m_connections)
+    {
+        ::shutdown(connection, SHUT_RD);
+    }
+    return;
+}
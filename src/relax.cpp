@@ -0,0 +1,165 @@
+#include "../include/relax.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RELAX_X86_DISPATCH 1
+#include <immintrin.h>
+#else
+#define RELAX_X86_DISPATCH 0
+#endif
+
+typedef std::pair<int, int> iPair;
+
+typedef void (*relax_kernel)(const int *, const int *, std::size_t, int, int *,
+                             std::vector<iPair> &);
+
+static void relaxScalar(const int *targets, const int *weights,
+                        std::size_t count, int du, int *distances,
+                        std::vector<iPair> &improved)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int v = targets[i];
+        int dv = du + weights[i];
+        // check if there is a shorter path from u to v
+        if (dv < distances[v])
+        {
+            distances[v] = dv;
+            improved.emplace_back(dv, v);
+        }
+    }
+    return;
+}
+
+#if RELAX_X86_DISPATCH
+
+/*
+ * Commits the lanes flagged in `mask`. The vector compare was done
+ * against the distances gathered before any lane was written, so the
+ * candidate is checked again here: the same target can appear more
+ * than once in a row (parallel edges with different weights), and
+ * only the lanes that still improve the distance may be pushed.
+ */
+static inline void commitLanes(unsigned mask, const int *targets,
+                               const int *candidates, int *distances,
+                               std::vector<iPair> &improved)
+{
+    while (mask)
+    {
+        int lane = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        int v = targets[lane];
+        if (candidates[lane] < distances[v])
+        {
+            distances[v] = candidates[lane];
+            improved.emplace_back(candidates[lane], v);
+        }
+    }
+    return;
+}
+
+__attribute__((target("avx2"))) static void
+relaxAvx2(const int *targets, const int *weights, std::size_t count, int du,
+          int *distances, std::vector<iPair> &improved)
+{
+    const __m256i vdu = _mm256_set1_epi32(du);
+    alignas(32) int candidates[8];
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(targets + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        __m256i cand = _mm256_add_epi32(vdu, w);
+        __m256i old = _mm256_i32gather_epi32(distances, idx, 4);
+
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(old, cand)));
+        if (mask)
+        {
+            _mm256_store_si256(reinterpret_cast<__m256i *>(candidates), cand);
+            commitLanes(mask, targets + i, candidates, distances, improved);
+        }
+    }
+    relaxScalar(targets + i, weights + i, count - i, du, distances, improved);
+    return;
+}
+
+__attribute__((target("avx512f"))) static void
+relaxAvx512(const int *targets, const int *weights, std::size_t count, int du,
+            int *distances, std::vector<iPair> &improved)
+{
+    const __m512i vdu = _mm512_set1_epi32(du);
+    alignas(64) int candidates[16];
+
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i idx = _mm512_loadu_si512(targets + i);
+        __m512i w = _mm512_loadu_si512(weights + i);
+        __m512i cand = _mm512_add_epi32(vdu, w);
+        __m512i old = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF,
+                                                   idx, distances, 4);
+
+        unsigned mask = _mm512_cmplt_epi32_mask(cand, old);
+        if (mask)
+        {
+            _mm512_store_si512(candidates, cand);
+            commitLanes(mask, targets + i, candidates, distances, improved);
+        }
+    }
+    relaxScalar(targets + i, weights + i, count - i, du, distances, improved);
+    return;
+}
+
+#endif /* RELAX_X86_DISPATCH */
+
+static relax_kernel selectKernel(const char **name)
+{
+#if RELAX_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        *name = "avx512";
+        return relaxAvx512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *name = "avx2";
+        return relaxAvx2;
+    }
+#endif
+    *name = "scalar";
+    return relaxScalar;
+}
+
+// The kernel is selected on first use; function local statics are
+// initialized exactly once, even with concurrent callers.
+static relax_kernel wideKernel(const char **name = nullptr)
+{
+    static const char *kernelName = nullptr;
+    static const relax_kernel kernel = selectKernel(&kernelName);
+    if (name)
+    {
+        *name = kernelName;
+    }
+    return kernel;
+}
+
+void relaxEdges(const int *targets, const int *weights, std::size_t count,
+                int du, int *distances, std::vector<iPair> &improved)
+{
+    if (count < relaxSimdThreshold)
+    {
+        relaxScalar(targets, weights, count, du, distances, improved);
+        return;
+    }
+    wideKernel()(targets, weights, count, du, distances, improved);
+    return;
+}
+
+const char *relaxKernelName()
+{
+    const char *name = nullptr;
+    wideKernel(&name);
+    return name;
+}
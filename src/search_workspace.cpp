@@ -0,0 +1,25 @@
+#include "../include/search_workspace.h"
+#include <algorithm>
+
+void search_workspace::reset(int vertices)
+{
+    // the heap keeps its capacity across searches
+    m_heap.clear();
+
+    if (++m_epoch == 0)
+    {
+        // the epoch wrapped around, forget every stamp
+        std::fill(m_distanceEpoch.begin(), m_distanceEpoch.end(), 0);
+        std::fill(m_targetEpoch.begin(), m_targetEpoch.end(), 0);
+        m_epoch = 1;
+    }
+
+    // new slots get epoch 0, which is never the current one
+    if (static_cast<int>(m_distances.size()) < vertices)
+    {
+        m_distances.resize(vertices);
+        m_distanceEpoch.resize(vertices, 0);
+        m_targetEpoch.resize(vertices, 0);
+    }
+    return;
+}
@@ -1,18 +1,128 @@
 #include "../include/shortestPath.h"
-#include <queue>
+#include "../include/profile_pool.h"
+#include "../include/relax.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 typedef std::pair<int, int> iPair;
 
 shortestPath::shortestPath(const graph &g)
+    : m_graph(g), m_compressed(nullptr), m_external(nullptr)
 {
-    m_graph = g.getAdjacencyList();
 }
 
-std::vector<int> shortestPath::compute(const int &source) const
+shortestPath::shortestPath(const graph &g, const vertex_ordering &order)
+    : m_graph(csr_graph(g), order), m_order(order), m_compressed(nullptr), m_external(nullptr)
+{
+}
+
+shortestPath::shortestPath(const compressed_graph &g) : m_compressed(&g), m_external(nullptr)
+{
+    if (g.maxTarget() >= g.countVertices())
+    {
+        throw std::invalid_argument("shortestPath: compressed_graph has edges to missing vertices");
+    }
+}
+
+shortestPath::shortestPath(std::shared_ptr<const graph_snapshot> snapshot)
+    : m_compressed(nullptr), m_external(nullptr), m_snapshot(snapshot)
+{
+}
+
+shortestPath::shortestPath(external_graph &g) : m_compressed(nullptr), m_external(&g)
+{
+}
+
+/*
+ * Neighbour iteration over the adjacency representations: calls
+ * f(v, weight) for every out-edge of u. The CSR copy also carries the
+ * ordering its rows are laid out in.
+ */
+struct csr_neighbours
+{
+    const csr_graph &g;
+    const vertex_ordering &order;
+
+    int countVertices() const
+    {
+        return g.countVertices();
+    }
+
+    template <class Function>
+    void operator()(int u, Function f) const
+    {
+        const int *targets = g.targets(u);
+        const int *weights = g.weights(u);
+        for (int i = 0; i < g.degree(u); ++i)
+        {
+            f(targets[i], weights[i]);
+        }
+    }
+};
+
+struct compressed_neighbours
+{
+    const compressed_graph &g;
+
+    int countVertices() const
+    {
+        return g.countVertices();
+    }
+
+    template <class Function>
+    void operator()(int u, Function f) const
+    {
+        g.forEachNeighbour(u, f);
+    }
+};
+
+struct snapshot_neighbours
+{
+    const graph_snapshot &g;
+
+    int countVertices() const
+    {
+        return g.countVertices();
+    }
+
+    template <class Function>
+    void operator()(int u, Function f) const
+    {
+        g.forEachNeighbour(u, f);
+    }
+};
+
+struct external_neighbours
+{
+    external_graph &g;
+
+    int countVertices() const
+    {
+        return g.countVertices();
+    }
+
+    template <class Function>
+    void operator()(int u, Function f) const
+    {
+        g.forEachNeighbour(u, f);
+    }
+};
+
+/*
+ * The Dijkstra loop shared by the adjacency representations. `relax`
+ * is called as relax(u, distances[u], distances, improved) for every
+ * settled vertex and must lower the distances of the out-neighbours
+ * of u, appending every updated (distance, vertex) pair to `improved`.
+ * `frontier(minHeap, distances)` is called right before, and may
+ * look at the vertices queued to be settled next.
+ */
+template <class Relax, class Frontier>
+static std::vector<int> dijkstra(int vertices, int source, Relax relax, Frontier frontier)
 {
     // initialize and set all distances to infinity.
     int inf = std::numeric_limits<int>::max();
-    std::vector<int> distances(m_graph.size(), inf);
+    std::vector<int> distances(vertices, inf);
 
     // create a min heap to store vertices that are being processed,
     // 1st element of the pair is the distance and 2nd is the vertex.
@@ -20,6 +130,10 @@ std::vector<int> shortestPath::compute(const int &source) const
     minHeap.insert(std::make_pair(0, source));
     distances[source] = 0;
 
+    // scratch buffer for the (distance, vertex) pairs improved by a
+    // single relaxation step, reused across iterations.
+    std::vector<iPair> improved;
+
     /* Loop till the heap is empty (or till all the distances are not
      * finalized. */
     while (!minHeap.empty())
@@ -30,19 +144,416 @@ std::vector<int> shortestPath::compute(const int &source) const
         auto up = minHeap.pop();
         int u = up.second;
 
-        for (auto vp : m_graph.at(u))
+        // skip stale entries, the vertex has already been settled
+        // with a shorter distance.
+        if (up.first > distances[u])
+        {
+            continue;
+        }
+
+        // relax all the out-edges of u and queue the vertices whose
+        // distance was updated.
+        frontier(minHeap, distances);
+        improved.clear();
+        relax(u, distances[u], distances, improved);
+        for (const auto &vp : improved)
         {
-            int v = vp.first;
-            int weight = vp.second;
+            minHeap.insert(vp);
+        }
+    }
+    return distances;
+}
+
+struct no_frontier
+{
+    void operator()(const heap<iPair> &, const std::vector<int> &) const {}
+};
+
+template <class Relax>
+static std::vector<int> dijkstra(int vertices, int source, Relax relax)
+{
+    return dijkstra(vertices, source, relax, no_frontier());
+}
+
+/*
+ * Dijkstra over a representation without a vectorized kernel, the
+ * out-edges are relaxed one by one as they are decoded.
+ */
+template <class Neighbours>
+static std::vector<int> dijkstraOver(int vertices, int source, Neighbours neighbours)
+{
+    return dijkstra(vertices, source,
+                    [&neighbours](int u, int du, std::vector<int> &distances,
+                                  std::vector<iPair> &improved) {
+                        neighbours(u, [&](int v, int weight) {
+                            // check if there is a shorter path from u to v
+                            if (distances[v] > du + weight)
+                            {
+                                distances[v] = du + weight;
+                                improved.emplace_back(distances[v], v);
+                            }
+                        });
+                    });
+}
+
+/*
+ * Time-dependent Dijkstra: the weights are profile ids, and every
+ * edge costs its travel time when leaving u at `start` + du. FIFO
+ * profiles make the earliest arrival at u the best time to leave it,
+ * so the vertices are still settled in their final order.
+ */
+template <class Neighbours>
+static std::vector<int> timeDependentDijkstra(int vertices, int source, int start,
+                                              Neighbours neighbours, const profile_pool &profiles)
+{
+    return dijkstra(vertices, source,
+                    [&neighbours, &profiles, start](int u, int du, std::vector<int> &distances,
+                                                    std::vector<iPair> &improved) {
+                        const int inf = std::numeric_limits<int>::max();
+                        if (du == inf)
+                        {
+                            return;
+                        }
+                        // u is left at time start + du, modulo the period
+                        int time = (static_cast<long long>(start) + du) % profiles.period();
+                        neighbours(u, [&](int v, int profile) {
+                            if (profile < 0 || profile >= profiles.size())
+                            {
+                                throw std::out_of_range(
+                                    "shortestPath: edge weight is not a profile id");
+                            }
+                            // summed in long long, an arrival past the
+                            // sentinel leaves v unreached
+                            long long dv = static_cast<long long>(du) +
+                                           profiles.evaluate(profile, time);
+                            if (dv < distances[v])
+                            {
+                                distances[v] = dv;
+                                improved.emplace_back(dv, v);
+                            }
+                        });
+                    });
+}
 
+/*
+ * Dijkstra over an external_graph. Only the distances and the heap
+ * are in memory; before settling a vertex, the rows of the vertices
+ * in the first levels of the heap (the frontier that is settled
+ * next) are read ahead, so that their blocks are on their way from
+ * the disk while the current row is relaxed.
+ */
+static std::vector<int> externalDijkstra(external_graph &g, int source)
+{
+    // the first three levels of the binary heap
+    const int readahead = 7;
+    return dijkstra(g.countVertices(), source,
+                    [&g](int u, int du, std::vector<int> &distances, std::vector<iPair> &improved) {
+                        // check if there is a shorter path from u to v
+                        g.forEachNeighbour(u, [&](int v, int weight) {
+                            if (distances[v] > du + weight)
+                            {
+                                distances[v] = du + weight;
+                                improved.emplace_back(distances[v], v);
+                            }
+                        });
+                    },
+                    [&g, readahead](const heap<iPair> &minHeap, const std::vector<int> &distances) {
+                        int count = 0;
+                        for (auto it = minHeap.begin(); it != minHeap.end() && count < readahead;
+                             ++it, ++count)
+                        {
+                            // stale entries will be skipped, not settled
+                            if (it->first <= distances[it->second])
+                            {
+                                g.prefetch(it->second);
+                            }
+                        }
+                    });
+}
+
+/*
+ * Dijkstra loop of the bounded searches, over the epoch stamped
+ * distances of the workspace. `settle(u, du)` is called once for
+ * every reached vertex, in increasing order of distance, and the
+ * search stops as soon as it returns false.
+ */
+template <class Neighbours, class Settle>
+static void boundedDijkstra(int source, search_workspace &workspace,
+                            Neighbours neighbours, Settle settle)
+{
+    heap<iPair> &minHeap = workspace.queue();
+    minHeap.insert(std::make_pair(0, source));
+    workspace.setDistance(source, 0);
+
+    while (!minHeap.empty())
+    {
+        auto up = minHeap.pop();
+        int u = up.second;
+        int du = up.first;
+
+        // skip stale entries
+        if (du > workspace.distance(u))
+        {
+            continue;
+        }
+        if (!settle(u, du))
+        {
+            return;
+        }
+
+        neighbours(u, [&workspace, &minHeap, du](int v, int weight) {
             // check if there is a shorter path from u to v
-            if (distances[v] > distances[u] + weight)
+            if (du + weight < workspace.distance(v))
             {
-                // update distance of v
-                distances[v] = distances[u] + weight;
-                minHeap.insert(std::make_pair(distances[v], v));
+                workspace.setDistance(v, du + weight);
+                minHeap.insert(std::make_pair(du + weight, v));
             }
+        });
+    }
+    return;
+}
+
+// distances by internal label to distances by graph label
+static std::vector<int> toExternal(const vertex_ordering &order, std::vector<int> distances)
+{
+    if (order.empty())
+    {
+        return distances;
+    }
+    std::vector<int> external(distances.size());
+    for (int v = 0; v < static_cast<int>(distances.size()); ++v)
+    {
+        external[order.toExternal(v)] = distances[v];
+    }
+    return external;
+}
+
+/*
+ * The searches of shortestPath, as functors called by withNeighbours
+ * with the neighbour iteration of the representation in use. The CSR
+ * copy runs on its internal labels, and has the vectorized kernels of
+ * relax.h; the external_graph reads ahead the rows of the frontier.
+ */
+struct vertex_count
+{
+    typedef int result_type;
+
+    template <class Neighbours>
+    int operator()(Neighbours neighbours) const
+    {
+        return neighbours.countVertices();
+    }
+};
+
+struct full_search
+{
+    typedef std::vector<int> result_type;
+
+    int source;
+
+    template <class Neighbours>
+    std::vector<int> operator()(Neighbours neighbours) const
+    {
+        // decode the rows on the fly, nothing is expanded up front.
+        return dijkstraOver(neighbours.countVertices(), source, neighbours);
+    }
+
+    std::vector<int> operator()(external_neighbours neighbours) const
+    {
+        return externalDijkstra(neighbours.g, source);
+    }
+
+    std::vector<int> operator()(csr_neighbours neighbours) const
+    {
+        const csr_graph &g = neighbours.g;
+        auto distances = dijkstra(g.countVertices(), neighbours.order.toInternal(source),
+                                  [&g](int u, int du, std::vector<int> &distances,
+                                       std::vector<iPair> &improved) {
+                                      relaxEdges(g.targets(u), g.weights(u), g.degree(u),
+                                                 du, distances.data(), improved);
+                                  });
+        return toExternal(neighbours.order, std::move(distances));
+    }
+};
+
+struct time_dependent_search
+{
+    typedef std::vector<int> result_type;
+
+    int source;
+    int start;
+    const profile_pool &profiles;
+
+    template <class Neighbours>
+    std::vector<int> operator()(Neighbours neighbours) const
+    {
+        return timeDependentDijkstra(neighbours.countVertices(), source, start, neighbours,
+                                     profiles);
+    }
+
+    std::vector<int> operator()(csr_neighbours neighbours) const
+    {
+        const vertex_ordering &order = neighbours.order;
+        return toExternal(order, timeDependentDijkstra(neighbours.countVertices(),
+                                                       order.toInternal(source), start,
+                                                       neighbours, profiles));
+    }
+};
+
+template <class Settle>
+struct bounded_search
+{
+    typedef void result_type;
+
+    int source;
+    search_workspace &workspace;
+    Settle settle;
+
+    template <class Neighbours>
+    void operator()(Neighbours neighbours) const
+    {
+        boundedDijkstra(source, workspace, neighbours, settle);
+        return;
+    }
+
+    void operator()(csr_neighbours neighbours) const
+    {
+        // the search runs on the internal labels of the CSR copy, the
+        // callback always sees the labels of the graph.
+        const vertex_ordering &order = neighbours.order;
+        const Settle &f = settle;
+        boundedDijkstra(order.toInternal(source), workspace, neighbours,
+                        [&order, &f](int u, int du) { return f(order.toExternal(u), du); });
+        return;
+    }
+};
+
+template <class F>
+auto shortestPath::withNeighbours(F f) const -> typename F::result_type
+{
+    if (m_compressed)
+    {
+        return f(compressed_neighbours{*m_compressed});
+    }
+    if (m_snapshot)
+    {
+        return f(snapshot_neighbours{*m_snapshot});
+    }
+    if (m_external)
+    {
+        return f(external_neighbours{*m_external});
+    }
+    return f(csr_neighbours{m_graph, m_order});
+}
+
+int shortestPath::countVertices() const
+{
+    return withNeighbours(vertex_count());
+}
+
+std::vector<int> shortestPath::compute(const int &source) const
+{
+    if (source < 0 || source >= countVertices())
+    {
+        throw std::out_of_range("shortestPath: source vertex not in graph");
+    }
+    return withNeighbours(full_search{source});
+}
+
+std::vector<int> shortestPath::compute(const int &source, int departure,
+                                       const profile_pool &profiles) const
+{
+    if (source < 0 || source >= countVertices())
+    {
+        throw std::out_of_range("shortestPath: source vertex not in graph");
+    }
+    if (departure < 0)
+    {
+        throw std::invalid_argument("shortestPath: negative departure time");
+    }
+
+    // the profiles are periodic, and starting from the first period
+    // keeps the clock (departure + travel time) far from overflowing.
+    int start = departure % profiles.period();
+    return withNeighbours(time_dependent_search{source, start, profiles});
+}
+
+template <class Settle>
+void shortestPath::boundedSearch(int source, search_workspace &workspace, Settle settle) const
+{
+    if (source < 0 || source >= countVertices())
+    {
+        throw std::out_of_range("shortestPath: source vertex not in graph");
+    }
+    withNeighbours(bounded_search<Settle>{source, workspace, settle});
+    return;
+}
+
+std::vector<std::pair<int, int>> shortestPath::computeWithin(const int &source, int radius,
+                                                            search_workspace &workspace) const
+{
+    std::vector<std::pair<int, int>> result;
+    workspace.reset(countVertices());
+    boundedSearch(source, workspace, [&result, radius](int u, int du) {
+        // the heap minimum is beyond the radius, so is everything else
+        if (du > radius)
+        {
+            return false;
         }
+        result.emplace_back(u, du);
+        return true;
+    });
+    return result;
+}
+
+std::vector<std::pair<int, int>> shortestPath::computeNearest(const int &source, int k,
+                                                             search_workspace &workspace) const
+{
+    std::vector<std::pair<int, int>> result;
+    if (k <= 0)
+    {
+        return result;
     }
-    return distances;
+    workspace.reset(countVertices());
+    boundedSearch(source, workspace, [&result, k](int u, int du) {
+        result.emplace_back(u, du);
+        return static_cast<int>(result.size()) < k;
+    });
+    return result;
+}
+
+std::vector<std::pair<int, int>> shortestPath::computeNearest(const int &source, int k,
+                                                             const std::vector<int> &targets,
+                                                             search_workspace &workspace) const
+{
+    std::vector<std::pair<int, int>> result;
+    if (k <= 0 || targets.empty())
+    {
+        return result;
+    }
+
+    // the targets are stamped into the workspace, so the membership
+    // test is O(1) without an array of the size of the graph.
+    int vertices = countVertices();
+    workspace.reset(vertices);
+    int remaining = 0;
+    for (int t : targets)
+    {
+        if (t >= 0 && t < vertices && !workspace.isTarget(t))
+        {
+            workspace.markTarget(t);
+            ++remaining;
+        }
+    }
+    remaining = std::min(remaining, k);
+
+    boundedSearch(source, workspace, [&result, &workspace, &remaining](int u, int du) {
+        if (workspace.isTarget(u))
+        {
+            result.emplace_back(u, du);
+            --remaining;
+        }
+        return remaining > 0;
+    });
+    return result;
 }
@@ -1,10 +1,22 @@
 #include "../include/undirected_weighted_graph.h"
+#include "../include/edge_batch.h"
 
 undirected_weighted_graph::undirected_weighted_graph(int vertices)
+    : undirected_weighted_graph(vertices, nullptr)
+{
+}
+
+undirected_weighted_graph::undirected_weighted_graph(std::shared_ptr<arena> pool)
+    : m_adjList(arena_allocator<adjacency_map::value_type>(pool))
+{
+}
+
+undirected_weighted_graph::undirected_weighted_graph(int vertices, std::shared_ptr<arena> pool)
+    : undirected_weighted_graph(pool)
 {
     for (int i = 0; i < vertices; ++i)
     {
-        m_adjList[i] = std::set<std::pair<int, int>>();
+        m_adjList.emplace_hint(m_adjList.end(), i, adjacency_set(m_adjList.get_allocator()));
     }
 }
 
@@ -14,34 +26,41 @@ void undirected_weighted_graph::addVertex(int vertex)
     // add it to the list.
     if (m_adjList.empty())
     {
-        m_adjList.emplace(vertex, std::set<std::pair<int, int>>());
+        m_adjList.emplace(vertex, adjacency_set(m_adjList.get_allocator()));
+        bumpVersion();
         return;
     }
     // check to see if the vertex is already in the adjacency list.
     // If not, add it to the list.
     if (m_adjList.find(vertex) == m_adjList.end())
     {
-        m_adjList.emplace(vertex, std::set<std::pair<int, int>>());
+        m_adjList.emplace(vertex, adjacency_set(m_adjList.get_allocator()));
+        bumpVersion();
     }
     return;
 }
 
 void undirected_weighted_graph::removeVertex(int vertex)
 {
-    // first delete the vertex
-    m_adjList.erase(vertex);
-
-    // remove all entries connected to the removed vertex
-    for (auto i : m_adjList)
+    auto it = m_adjList.find(vertex);
+    if (it != m_adjList.end())
     {
-        for (auto j : i.second)
+        // every edge is stored in both directions, so the entries to
+        // the removed vertex are in the sets of its own neighbours.
+        for (const auto &j : it->second)
         {
-            if (j.first == vertex)
+            auto neighbour = m_adjList.find(j.first);
+            if (j.first != vertex && neighbour != m_adjList.end())
             {
-                i.second.erase(j);
+                m_entries -= eraseEntries(neighbour->second, vertex);
             }
         }
+
+        // then delete the vertex
+        m_entries -= it->second.size();
+        m_adjList.erase(it);
     }
+    bumpVersion();
     return;
 }
 
@@ -59,8 +78,32 @@ void undirected_weighted_graph::addEdge(int source, int dest, int weight)
 
     // create connections between the source and destination
     // vertices
-    m_adjList[start].emplace(end, weight);
-    m_adjList[end].emplace(start, weight);
+    m_entries += m_adjList.find(start)->second.emplace(end, weight).second;
+    m_entries += m_adjList.find(end)->second.emplace(start, weight).second;
+    bumpVersion();
+    return;
+}
+
+void undirected_weighted_graph::addEdges(const std::vector<weighted_edge> &edges)
+{
+    // every edge is stored in both directions, exactly like
+    // addEdge does it.
+    std::vector<weighted_edge> batch;
+    batch.reserve(2 * edges.size());
+    for (const auto &e : edges)
+    {
+        batch.push_back(e);
+        if (e.source != e.dest)
+        {
+            batch.push_back(weighted_edge{e.dest, e.source, e.weight});
+        }
+    }
+
+    // sort and deduplicate the batch, then append it to the
+    // adjacency list in a single ordered pass.
+    sortEdges(batch);
+    m_entries += insertSortedEdges(m_adjList, batch);
+    bumpVersion();
     return;
 }
 
@@ -74,23 +117,14 @@ void undirected_weighted_graph::removeEdge(int source, int dest)
     int end = source < dest ? dest : source;
 
     // remove the connections between source and destination
-    if (m_adjList.find(start) != m_adjList.end())
+    auto first = m_adjList.find(start);
+    auto second = m_adjList.find(end);
+    if (first != m_adjList.end() && second != m_adjList.end())
     {
-        for (auto d : m_adjList[start])
-        {
-            if (d.first == end)
-            {
-                m_adjList[start].erase(d);
-            }
-        }
-        for (auto d : m_adjList[end])
-        {
-            if (d.first == start)
-            {
-                m_adjList[end].erase(d);
-            }
-        }
+        m_entries -= eraseEntries(first->second, end);
+        m_entries -= eraseEntries(second->second, start);
     }
+    bumpVersion();
     return;
 }
 
@@ -99,15 +133,14 @@ int undirected_weighted_graph::countVertices()
     return m_adjList.size();
 }
 
-int undirected_weighted_graph::countEdges()
+std::size_t undirected_weighted_graph::countEdges()
 {
-    // iterate through the map and sum up the set sizes.
-    int edges = 0;
-    for (auto i : m_adjList)
-    {
-        edges += i.second.size();
-    }
-    return edges / 2;
+    return m_entries / 2;
+}
+
+graph_memory undirected_weighted_graph::memoryUsage() const
+{
+    return adjacencyMemory(m_adjList, m_entries, sizeof(*this));
 }
 
 bool undirected_weighted_graph::writeDot(std::string filename)
@@ -159,7 +192,14 @@ std::vector<int> undirected_weighted_graph::getVertices() const
 
 std::map<int, std::set<std::pair<int, int>>> undirected_weighted_graph::getAdjacencyList() const
 {
-    return m_adjList;
+    // copy into the standard containers of the graph interface
+    std::map<int, std::set<std::pair<int, int>>> adjList;
+    for (const auto &it : m_adjList)
+    {
+        adjList.emplace_hint(adjList.end(), it.first,
+                             std::set<std::pair<int, int>>(it.second.begin(), it.second.end()));
+    }
+    return adjList;
 }
 
 std::ostream &operator<<(std::ostream &oss, const undirected_weighted_graph &graph)
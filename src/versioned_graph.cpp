@@ -0,0 +1,253 @@
+#include "../include/versioned_graph.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+const int graph_snapshot::chunkBits;
+const int graph_snapshot::chunkSize;
+
+static void checkLabel(int vertex)
+{
+    if (vertex < 0)
+    {
+        throw std::out_of_range("versioned_graph: negative vertex label");
+    }
+    return;
+}
+
+versioned_graph::versioned_graph(bool directed) : m_directed(directed)
+{
+    std::shared_ptr<graph_snapshot> first = std::make_shared<graph_snapshot>();
+    first->m_directed = directed;
+    m_current = first;
+}
+
+versioned_graph::versioned_graph(const directed_weighted_graph &g)
+    : versioned_graph(g.getAdjacencyList(), true)
+{
+}
+
+versioned_graph::versioned_graph(const undirected_weighted_graph &g)
+    : versioned_graph(g.getAdjacencyList(), false)
+{
+}
+
+versioned_graph::versioned_graph(const std::map<int, std::set<std::pair<int, int>>> &adjList,
+                                 bool directed)
+    : versioned_graph(directed)
+{
+    // the initial contents are published as a single batch
+    for (const auto &it : adjList)
+    {
+        staged_vertex &v = stage(it.first);
+        v.present = true;
+        v.edges.assign(it.second.begin(), it.second.end());
+    }
+    publish();
+}
+
+std::shared_ptr<const graph_snapshot> versioned_graph::snapshot() const
+{
+    return std::atomic_load(&m_current);
+}
+
+versioned_graph::staged_vertex &versioned_graph::stage(int vertex)
+{
+    checkLabel(vertex);
+    auto it = m_staged.find(vertex);
+    if (it != m_staged.end())
+    {
+        return it->second;
+    }
+
+    // first change of this vertex in the batch, start from the
+    // published version. Only the writer stores m_current, so it can
+    // be read here without the atomic functions.
+    staged_vertex staged;
+    const auto &list = m_current->list(vertex);
+    staged.present = static_cast<bool>(list);
+    if (list)
+    {
+        staged.edges = *list;
+    }
+    return m_staged.emplace(vertex, staged).first->second;
+}
+
+bool versioned_graph::hasVertex(int vertex) const
+{
+    auto it = m_staged.find(vertex);
+    return it != m_staged.end() ? it->second.present : m_current->hasVertex(vertex);
+}
+
+void versioned_graph::insertEntry(int source, int dest, int weight)
+{
+    // keep the list sorted and free of duplicates, like a std::set
+    auto &edges = stage(source).edges;
+    auto entry = std::make_pair(dest, weight);
+    auto pos = std::lower_bound(edges.begin(), edges.end(), entry);
+    if (pos == edges.end() || *pos != entry)
+    {
+        edges.insert(pos, entry);
+    }
+    return;
+}
+
+void versioned_graph::eraseEntries(int source, int dest)
+{
+    // all the parallel edges to `dest` are adjacent in the list
+    auto &edges = stage(source).edges;
+    auto first = std::lower_bound(edges.begin(), edges.end(),
+                                  std::make_pair(dest, std::numeric_limits<int>::min()));
+    auto last = first;
+    while (last != edges.end() && last->first == dest)
+    {
+        ++last;
+    }
+    edges.erase(first, last);
+    return;
+}
+
+void versioned_graph::addVertex(int vertex)
+{
+    stage(vertex).present = true;
+    return;
+}
+
+void versioned_graph::removeVertex(int vertex)
+{
+    checkLabel(vertex);
+    if (!hasVertex(vertex))
+    {
+        return;
+    }
+    staged_vertex &removed = stage(vertex);
+
+    // find the vertices with an edge to the removed one. For an
+    // undirected graph they are its own neighbours, a directed graph
+    // has to be scanned as a whole.
+    std::vector<int> sources;
+    if (!m_directed)
+    {
+        for (const auto &e : removed.edges)
+        {
+            sources.push_back(e.first);
+        }
+    }
+    else
+    {
+        auto hasEdgeTo = [vertex](const graph_snapshot::edge_list &edges) {
+            auto pos = std::lower_bound(edges.begin(), edges.end(),
+                                        std::make_pair(vertex, std::numeric_limits<int>::min()));
+            return pos != edges.end() && pos->first == vertex;
+        };
+        for (int v = 0; v < m_current->countVertices(); ++v)
+        {
+            if (m_staged.find(v) == m_staged.end() && hasEdgeTo(m_current->edges(v)))
+            {
+                sources.push_back(v);
+            }
+        }
+        for (const auto &it : m_staged)
+        {
+            if (hasEdgeTo(it.second.edges))
+            {
+                sources.push_back(it.first);
+            }
+        }
+    }
+
+    for (int source : sources)
+    {
+        eraseEntries(source, vertex);
+    }
+    removed.present = false;
+    removed.edges.clear();
+    return;
+}
+
+void versioned_graph::addEdge(int source, int dest, int weight)
+{
+    stage(source).present = true;
+    stage(dest).present = true;
+    insertEntry(source, dest, weight);
+    if (!m_directed)
+    {
+        insertEntry(dest, source, weight);
+    }
+    return;
+}
+
+void versioned_graph::removeEdge(int source, int dest)
+{
+    checkLabel(source);
+    checkLabel(dest);
+    // an edge always has both ends in the graph
+    if (!hasVertex(source) || !hasVertex(dest))
+    {
+        return;
+    }
+    eraseEntries(source, dest);
+    if (!m_directed)
+    {
+        eraseEntries(dest, source);
+    }
+    return;
+}
+
+std::size_t versioned_graph::pending() const
+{
+    return m_staged.size();
+}
+
+std::shared_ptr<const graph_snapshot> versioned_graph::publish()
+{
+    const graph_snapshot &current = *m_current;
+    if (m_staged.empty())
+    {
+        return m_current;
+    }
+
+    // shallow copy: the new version shares every chunk for now
+    std::shared_ptr<graph_snapshot> next = std::make_shared<graph_snapshot>(current);
+    next->m_version = current.m_version + 1;
+
+    int vertices = std::max(current.m_vertices, m_staged.rbegin()->first + 1);
+    next->m_vertices = vertices;
+    next->m_chunks.resize((vertices + graph_snapshot::chunkSize - 1) >> graph_snapshot::chunkBits);
+
+    // the staged vertices are sorted, so all the vertices of a chunk
+    // are visited in a row and every touched chunk is copied once.
+    std::shared_ptr<graph_snapshot::chunk> chunk;
+    int chunkIndex = -1;
+    for (auto &it : m_staged)
+    {
+        int vertex = it.first;
+        if (vertex >> graph_snapshot::chunkBits != chunkIndex)
+        {
+            chunkIndex = vertex >> graph_snapshot::chunkBits;
+            const auto &shared = next->m_chunks[chunkIndex];
+            chunk = shared ? std::make_shared<graph_snapshot::chunk>(*shared)
+                           : std::make_shared<graph_snapshot::chunk>(graph_snapshot::chunkSize);
+            next->m_chunks[chunkIndex] = chunk;
+        }
+
+        auto &slot = (*chunk)[vertex & (graph_snapshot::chunkSize - 1)];
+        if (slot)
+        {
+            next->m_entries -= slot->size();
+        }
+        if (it.second.present)
+        {
+            slot = std::make_shared<const graph_snapshot::edge_list>(std::move(it.second.edges));
+            next->m_entries += slot->size();
+        }
+        else
+        {
+            slot.reset();
+        }
+    }
+    m_staged.clear();
+
+    std::atomic_store(&m_current, std::shared_ptr<const graph_snapshot>(next));
+    return next;
+}